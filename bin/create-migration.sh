@@ -28,6 +28,8 @@ echo "-- +migrate Up" >> $filepath
 echo "" >> $filepath
 echo "-- +migrate Down" >> $filepath
 
-resourceFile="$(pwd)/res_migrations.qrc"
+resourceFile="$migrationsPath/res_migrations.qrc"
 
-./bin/update_migration_resource.py "$resourceFile" "migrations/$filename"
+# the resource file lives alongside the migrations, so entries are relative to that directory.
+# this also regenerates the migration manifest; re-run it (without a filename) after editing a migration
+./bin/update_migration_resource.py "$resourceFile" "$filename"
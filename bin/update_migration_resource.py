@@ -1,31 +1,89 @@
 #! /usr/bin/env python
 
+# Adds a migration to the migration resource file (if one is provided), then regenerates the
+# migration manifest (src/db/migrationmanifest.h): the ordered list of every migration in the
+# resource file, along with a hash of its content. The application only applies migrations listed
+# in the manifest, so this must be re-run whenever a migration is added or changed.
+#
+# usage: update_migration_resource.py path/to/res_migrations.qrc [new_migration_filename]
+
+import hashlib
+import os
 import xml.etree.ElementTree as ET
 import sys
 
+MIGRATION_PREFIX = '/migrations'
+MANIFEST_TEMPLATE = """// Generated by bin/update_migration_resource.py. Do not edit.
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
 
-def main():
-    if len(sys.argv) < 3:
-        print("Project root not provided.")
-        return
+#pragma once
 
-    migration_file = sys.argv[1]
-    new_filename = sys.argv[2]
-    tree = ET.parse(migration_file)
-    root = tree.getroot()
+#include <array>
 
+/// MigrationManifestEntry names a migration (relative to :/migrations) and the sha256 of its content
+struct MigrationManifestEntry {{
+  const char* name;
+  const char* sha256;
+}};
+
+/// migrationManifest lists every migration, in the order they must be applied
+inline constexpr std::array<MigrationManifestEntry, {count}> migrationManifest {{{{
+{entries}
+}}}};
+"""
+
+
+def add_migration(tree, new_filename):
+    root = tree.getroot()
     for child in root:
-        if child.attrib.get('prefix') == '/':
+        if child.attrib.get('prefix') == MIGRATION_PREFIX:
             newFileEntry = ET.SubElement(child, "file")
             newFileEntry.text = new_filename
             # try to keep pretty -- not really necessary
             if len(child) > 1:
                 child[-2].tail = "\n        "
-            newFileEntry.tail ="\n    "
-            break
+            newFileEntry.tail = "\n    "
+            return True
+    return False
+
+
+def write_manifest(tree, migration_file, manifest_file):
+    migration_dir = os.path.dirname(os.path.abspath(migration_file))
+    names = []
+    for child in tree.getroot():
+        if child.attrib.get('prefix') == MIGRATION_PREFIX:
+            names.extend(entry.text for entry in child if entry.text.endswith('.sql'))
+
+    entries = []
+    for name in sorted(names):
+        with open(os.path.join(migration_dir, name), 'rb') as f:
+            digest = hashlib.sha256(f.read()).hexdigest()
+        entries.append('    {"%s", "%s"},' % (name, digest))
+
+    with open(manifest_file, 'w') as f:
+        f.write(MANIFEST_TEMPLATE.format(count=len(entries), entries='\n'.join(entries)))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Migration resource file not provided.")
+        return 1
+
+    migration_file = sys.argv[1]
+    tree = ET.parse(migration_file)
+
+    if len(sys.argv) > 2:
+        if not add_migration(tree, sys.argv[2]):
+            print("No %s resource found in %s" % (MIGRATION_PREFIX, migration_file))
+            return 1
+        tree.write(migration_file)
+        with open(migration_file, 'a') as f:
+            f.write('\n')
 
-    tree.write(migration_file)
+    project_root = os.path.dirname(os.path.dirname(os.path.abspath(migration_file)))
+    write_manifest(tree, migration_file, os.path.join(project_root, 'src', 'db', 'migrationmanifest.h'))
+    return 0
 
 
 if __name__ == "__main__":
-    main()
+    sys.exit(main())
@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE VIRTUAL TABLE IF NOT EXISTS evidence_fts USING fts5(description, content, tokenize = 'unicode61 remove_diacritics 2');
+
+-- +migrate Down
+DROP TABLE IF EXISTS evidence_fts;
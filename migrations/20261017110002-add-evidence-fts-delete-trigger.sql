@@ -0,0 +1,7 @@
+-- +migrate Up
+CREATE TRIGGER IF NOT EXISTS evidence_fts_delete AFTER DELETE ON evidence BEGIN
+    DELETE FROM evidence_fts WHERE rowid = old.id;
+END;
+
+-- +migrate Down
+DROP TRIGGER IF EXISTS evidence_fts_delete;
@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX IF NOT EXISTS evidence_operation_recorded_ms_idx ON evidence (operation_slug, recorded_ms);
+
+-- +migrate Down
+DROP INDEX IF EXISTS evidence_operation_recorded_ms_idx;
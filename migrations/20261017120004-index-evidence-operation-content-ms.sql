@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX IF NOT EXISTS evidence_operation_content_ms_idx ON evidence (operation_slug, content_type, recorded_ms);
+
+-- +migrate Down
+DROP INDEX IF EXISTS evidence_operation_content_ms_idx;
@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX IF NOT EXISTS evidence_recorded_ms_idx ON evidence (recorded_ms);
+
+-- +migrate Down
+DROP INDEX IF EXISTS evidence_recorded_ms_idx;
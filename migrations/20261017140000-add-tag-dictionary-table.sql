@@ -0,0 +1,10 @@
+-- +migrate Up
+CREATE TABLE tag_dictionary (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    server_tag_id INTEGER NOT NULL UNIQUE,
+    name TEXT NOT NULL,
+    color TEXT
+);
+
+-- +migrate Down
+DROP TABLE tag_dictionary;
@@ -0,0 +1,10 @@
+-- +migrate Up
+CREATE TABLE evidence_tags (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    evidence_id INTEGER NOT NULL,
+    tag_id INTEGER NOT NULL,
+    UNIQUE (evidence_id, tag_id)
+);
+
+-- +migrate Down
+DROP TABLE evidence_tags;
@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX IF NOT EXISTS evidence_tags_tag_id_idx ON evidence_tags (tag_id);
+
+-- +migrate Down
+DROP INDEX IF EXISTS evidence_tags_tag_id_idx;
@@ -0,0 +1,5 @@
+-- +migrate Up
+ALTER TABLE migrations ADD COLUMN progress INTEGER;
+
+-- +migrate Down
+-- cannot do a proper migrate down (SQLite does not support ALTER TABLE DROP COLUMN)
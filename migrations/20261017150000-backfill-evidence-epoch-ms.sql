@@ -0,0 +1,7 @@
+-- +migrate Up batch evidence
+UPDATE evidence SET
+    recorded_ms = COALESCE(CAST(ROUND((julianday(recorded_date) - 2440587.5) * 86400000) AS INTEGER), 0),
+    upload_ms = CAST(ROUND((julianday(upload_date) - 2440587.5) * 86400000) AS INTEGER)
+WHERE recorded_ms IS NULL AND id > ? AND id <= ?;
+
+-- +migrate Down
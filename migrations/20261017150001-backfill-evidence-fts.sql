@@ -0,0 +1,5 @@
+-- +migrate Up batch evidence
+INSERT INTO evidence_fts (rowid, description) SELECT id, description FROM evidence WHERE id > ? AND id <= ?;
+
+-- +migrate Down
+-- nothing to do, the index is dropped with the table
@@ -0,0 +1,8 @@
+-- +migrate Up batch tags
+-- tags are visited in order, so the most recently applied name wins, in case a tag was renamed between uses
+INSERT INTO tag_dictionary (server_tag_id, name)
+SELECT tag_id, name FROM tags WHERE id > ? AND id <= ? ORDER BY id
+ON CONFLICT (server_tag_id) DO UPDATE SET name = excluded.name;
+
+-- +migrate Down
+DELETE FROM tag_dictionary;
@@ -0,0 +1,7 @@
+-- +migrate Up batch tags
+INSERT OR IGNORE INTO evidence_tags (id, evidence_id, tag_id)
+SELECT t.id, t.evidence_id, d.id FROM tags AS t JOIN tag_dictionary AS d ON d.server_tag_id = t.tag_id
+WHERE t.id > ? AND t.id <= ? ORDER BY t.id;
+
+-- +migrate Down
+DELETE FROM evidence_tags;
@@ -0,0 +1,7 @@
+-- +migrate Up batch tags
+-- the tags table is kept, so that exported databases stay readable by older versions, but it is
+-- only written when exporting
+DELETE FROM tags WHERE id > ? AND id <= ?;
+
+-- +migrate Down
+-- cannot do a proper migrate down (the per-evidence tag names are no longer stored)
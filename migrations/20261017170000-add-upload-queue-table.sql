@@ -0,0 +1,12 @@
+-- +migrate Up
+CREATE TABLE upload_queue (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    evidence_id INTEGER NOT NULL UNIQUE,
+    attempts INTEGER NOT NULL DEFAULT 0,
+    next_attempt_ms INTEGER NOT NULL DEFAULT 0,
+    last_error TEXT,
+    queued_ms INTEGER NOT NULL
+);
+
+-- +migrate Down
+DROP TABLE upload_queue;
@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX IF NOT EXISTS upload_queue_next_attempt_idx ON upload_queue (next_attempt_ms);
+
+-- +migrate Down
+DROP INDEX IF EXISTS upload_queue_next_attempt_idx;
@@ -0,0 +1,14 @@
+-- +migrate Up
+CREATE TABLE tag_outbox (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    operation_slug TEXT NOT NULL,
+    name TEXT NOT NULL,
+    color TEXT NOT NULL,
+    server_tag_id INTEGER,
+    abandoned INTEGER NOT NULL DEFAULT 0,
+    last_error TEXT,
+    queued_ms INTEGER NOT NULL
+);
+
+-- +migrate Down
+DROP TABLE tag_outbox;
@@ -104,6 +104,33 @@ QString AppConfig::defaultValue(const QString &key)
     if (key == CONFIG::APIURL)
         return QStringLiteral("http://localhost:8080");
 
+    // Database tuning; see SqlitePragmas for the accepted values
+    if (key == CONFIG::DB_JOURNAL_MODE)
+        return QStringLiteral("WAL");
+
+    if (key == CONFIG::DB_SYNCHRONOUS)
+        return QStringLiteral("NORMAL");
+
+    if (key == CONFIG::DB_MMAP_SIZE)
+        return QStringLiteral("268435456");
+
+    if (key == CONFIG::DB_CACHE_SIZE)
+        return QStringLiteral("-16000");
+
+    if (key == CONFIG::DB_TEMP_STORE)
+        return QStringLiteral("MEMORY");
+
+    if (key == CONFIG::DB_BUSY_TIMEOUT)
+        return QStringLiteral("5000");
+
+    // statements slower than this (in milliseconds) are logged; -1 disables the log
+    if (key == CONFIG::DB_SLOW_QUERY_MS)
+        return QStringLiteral("100");
+
+    // the number of evidence uploads the upload queue runs at once
+    if (key == CONFIG::UPLOAD_CONCURRENCY)
+        return QStringLiteral("3");
+
     if (key == CONFIG::SHORTCUT_CAPTURECLIPBOARD) {
           if(!get()->appSettings->value(key).isValid())
               return QStringLiteral("Meta+Alt+v");
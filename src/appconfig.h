@@ -21,6 +21,15 @@ struct CONFIG {
     inline static const auto COMMAND_CAPTUREWINDOW = QStringLiteral("captureWindowExec");
     inline static const auto SHORTCUT_CAPTUREWINDOW = QStringLiteral("captureWindowShortcut");
     inline static const auto SHORTCUT_CAPTURECLIPBOARD = QStringLiteral("captureClipboardShortcut");
+    inline static const auto DB_JOURNAL_MODE = QStringLiteral("dbJournalMode");
+    inline static const auto DB_SYNCHRONOUS = QStringLiteral("dbSynchronous");
+    inline static const auto DB_MMAP_SIZE = QStringLiteral("dbMmapSize");
+    inline static const auto DB_CACHE_SIZE = QStringLiteral("dbCacheSize");
+    inline static const auto DB_TEMP_STORE = QStringLiteral("dbTempStore");
+    inline static const auto DB_BUSY_TIMEOUT = QStringLiteral("dbBusyTimeout");
+    inline static const auto DB_SLOW_QUERY_MS = QStringLiteral("dbSlowQueryMs");
+    inline static const auto DB_QUERY_STATS_FILE = QStringLiteral("dbQueryStatsFile");
+    inline static const auto UPLOAD_CONCURRENCY = QStringLiteral("uploadConcurrency");
 };
 
 /// AppConfig is a singleton for accessing the application's configuration.
@@ -102,5 +111,14 @@ private:
         CONFIG::COMMAND_CAPTUREWINDOW,
         CONFIG::SHORTCUT_CAPTUREWINDOW,
         CONFIG::SHORTCUT_CAPTURECLIPBOARD,
+        CONFIG::DB_JOURNAL_MODE,
+        CONFIG::DB_SYNCHRONOUS,
+        CONFIG::DB_MMAP_SIZE,
+        CONFIG::DB_CACHE_SIZE,
+        CONFIG::DB_TEMP_STORE,
+        CONFIG::DB_BUSY_TIMEOUT,
+        CONFIG::DB_SLOW_QUERY_MS,
+        CONFIG::DB_QUERY_STATS_FILE,
+        CONFIG::UPLOAD_CONCURRENCY,
     };
 };
@@ -0,0 +1,551 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+// ashirt_db_bench builds synthetic evidence databases of a few sizes, times the common database
+// operations against each, and writes the results as JSON or CSV so they can be compared between
+// builds. It also checks that every evidence filter is read through an index on recorded_ms (the
+// epoch indexes), rather than the whole evidence table, and exits with an error if one is not.
+// Example:
+//   ashirt_db_bench --sizes 1000,100000 --format csv --out results.csv
+// With --check-plans, only the query plans are checked (this is what ctest runs).
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include "db/databaseconnection.h"
+#include "db/rowdecoders.h"
+#include "models/codeblock.h"
+
+namespace {
+
+/// Result is the timing of a single benchmark, over every iteration
+struct Result {
+  QString name;
+  qint64 dbRows = 0;
+  int iterations = 0;
+  qint64 totalUs = 0;
+  qint64 minUs = 0;
+  qint64 maxUs = 0;
+  /// rows is the number of rows read or written per iteration (summed, for multi-row operations)
+  qint64 rows = 0;
+};
+
+/// legacyMigrationCutoff is the first migration the legacy (pre-optimization) schema lacks
+const auto legacyMigrationCutoff = QStringLiteral("20261017");
+const int operationCount = 10;
+const int serverTagCount = 20;
+const int populateChunkSize = 50000;
+
+class Bench {
+ public:
+  explicit Bench(QString workDir) : _workDir(std::move(workDir)) {}
+
+  void runAll(qint64 dbRows);
+  /// checkPlans populates a db of dbRows evidence, then only checks the filter query plans
+  void checkPlans(qint64 dbRows);
+  const QList<Result>& results() const { return _results; }
+  /// planFailures lists each filter whose query plan scans the whole evidence table, or does not use
+  /// an epoch index
+  const QStringList& planFailures() const { return _planFailures; }
+
+ private:
+  /// measure runs action iterations times; action returns the rows it touched
+  void measure(const QString& name, qint64 dbRows, int iterations,
+               const std::function<qint64()>& action);
+  void populate(DatabaseConnection& db, qint64 dbRows);
+  void benchFilters(DatabaseConnection& db, qint64 dbRows);
+  void checkFilterPlans(const QString& connectionName, qint64 dbRows);
+  void benchTags(DatabaseConnection& db, qint64 dbRows);
+  void benchDecode(const QString& connectionName, qint64 dbRows);
+  void benchMigrations(qint64 dbRows);
+  bool buildLegacyDb(const QString& path, qint64 dbRows);
+
+  static model::Evidence syntheticEvidence(qint64 id);
+  static QList<QPair<QString, EvidenceFilters>> filterCases();
+  QString dbPath(const QString& name, qint64 dbRows) const {
+    return QStringLiteral("%1/%2-%3.sqlite").arg(_workDir, name).arg(dbRows);
+  }
+
+  QString _workDir;
+  QList<Result> _results;
+  QStringList _planFailures;
+  QRandomGenerator _random{20261017};
+};
+
+void Bench::measure(const QString& name, qint64 dbRows, int iterations,
+                    const std::function<qint64()>& action)
+{
+  Result result;
+  result.name = name;
+  result.dbRows = dbRows;
+  result.iterations = iterations;
+  result.minUs = std::numeric_limits<qint64>::max();
+  for (int i = 0; i < iterations; i++) {
+    QElapsedTimer timer;
+    timer.start();
+    result.rows += action();
+    auto elapsed = timer.nsecsElapsed() / 1000;
+    result.totalUs += elapsed;
+    result.minUs = std::min(result.minUs, elapsed);
+    result.maxUs = std::max(result.maxUs, elapsed);
+  }
+  qInfo().noquote() << QStringLiteral("%1 @ %2 rows: %3 ms")
+                           .arg(name).arg(dbRows).arg(result.totalUs / 1000.0 / iterations, 0, 'f', 2);
+  _results.append(result);
+}
+
+model::Evidence Bench::syntheticEvidence(qint64 id)
+{
+  // a deterministic spread of values, so every filter matches a predictable share of the rows
+  static const auto start = QDateTime(QDate(2025, 1, 1), QTime(0, 0), Qt::UTC);
+  model::Evidence evi;
+  evi.id = id;
+  evi.operationSlug = QStringLiteral("op-%1").arg(id % operationCount);
+  evi.contentType = (id % 5 == 0) ? Codeblock::contentType() : QStringLiteral("image");
+  evi.path = QStringLiteral("/evidence/%1/%2.png").arg(evi.operationSlug).arg(id);
+  evi.description = (id % 200 == 0) ? QStringLiteral("found the needle in evidence %1").arg(id)
+                                    : QStringLiteral("captured screen %1 of the target host").arg(id);
+  evi.errorText = (id % 100 == 0) ? QStringLiteral("upload failed") : QString();
+  evi.recordedDate = start.addSecs(id * 60);
+  if (id % 2 == 0)
+    evi.uploadDate = evi.recordedDate.addSecs(30);
+  return evi;
+}
+
+void Bench::populate(DatabaseConnection& db, qint64 dbRows)
+{
+  // rows are generated (and copied) a chunk at a time, so a 1M row db does not need 1M models at once
+  Result copy{QStringLiteral("batchCopyFullEvidence"), dbRows, 0, 0, 0, 0, 0};
+  Result tags{QStringLiteral("batchCopyTags"), dbRows, 0, 0, 0, 0, 0};
+  copy.minUs = tags.minUs = std::numeric_limits<qint64>::max();
+  qint64 tagRowID = 1;
+  for (qint64 offset = 0; offset < dbRows; offset += populateChunkSize) {
+    QList<model::Evidence> chunk;
+    QList<model::Tag> chunkTags;
+    for (qint64 id = offset + 1; id <= std::min(dbRows, offset + populateChunkSize); id++) {
+      chunk.append(syntheticEvidence(id));
+      for (qint64 t = 0; t < id % 3; t++) {
+        auto serverTagID = (id + t) % serverTagCount + 1;
+        chunkTags.append(model::Tag(tagRowID++, id, serverTagID, QStringLiteral("tag-%1").arg(serverTagID)));
+      }
+    }
+    auto addTiming = [](Result& r, qint64 elapsed, qint64 rows) {
+      r.iterations++;
+      r.totalUs += elapsed;
+      r.rows += rows;
+      r.minUs = std::min(r.minUs, elapsed);
+      r.maxUs = std::max(r.maxUs, elapsed);
+    };
+    QElapsedTimer timer;
+    timer.start();
+    db.batchCopyFullEvidence(chunk);
+    addTiming(copy, timer.nsecsElapsed() / 1000, chunk.size());
+    timer.restart();
+    db.batchCopyTags(chunkTags);
+    addTiming(tags, timer.nsecsElapsed() / 1000, chunkTags.size());
+  }
+  _results.append(copy);
+  _results.append(tags);
+
+  // copied evidence is not indexed for search (exports do not need it), so index it here
+  QSqlQuery index(QSqlDatabase::database(QStringLiteral("bench")));
+  measure(QStringLiteral("searchIndexBackfill"), dbRows, 1, [&index] {
+    index.exec(QStringLiteral("INSERT INTO evidence_fts (rowid, description) SELECT id, description FROM evidence"));
+    return qint64(index.numRowsAffected());
+  });
+}
+
+QList<QPair<QString, EvidenceFilters>> Bench::filterCases()
+{
+  const auto firstDay = QDate(2025, 1, 1);
+  auto filterOf = [](const std::function<void(EvidenceFilters&)>& set) {
+    EvidenceFilters filters;
+    set(filters);
+    return filters;
+  };
+  const QList<QPair<QString, EvidenceFilters>> cases {
+    {QStringLiteral("none"), EvidenceFilters()},
+    {QStringLiteral("err"), filterOf([](EvidenceFilters& f) { f.hasError = Tri::Yes; })},
+    {QStringLiteral("submitted"), filterOf([](EvidenceFilters& f) { f.submitted = Tri::No; })},
+    {QStringLiteral("op"), filterOf([](EvidenceFilters& f) { f.operationSlug = QStringLiteral("op-3"); })},
+    {QStringLiteral("type"), filterOf([](EvidenceFilters& f) { f.contentType = Codeblock::contentType(); })},
+    {QStringLiteral("from"), filterOf([firstDay](EvidenceFilters& f) { f.startDate = firstDay.addDays(7); })},
+    {QStringLiteral("to"), filterOf([firstDay](EvidenceFilters& f) { f.endDate = firstDay.addDays(7); })},
+    {QStringLiteral("on"), filterOf([firstDay](EvidenceFilters& f) { f.startDate = f.endDate = firstDay.addDays(2); })},
+    {QStringLiteral("text"), filterOf([](EvidenceFilters& f) { f.searchText = QStringLiteral("needle"); })},
+    {QStringLiteral("op+type"), filterOf([](EvidenceFilters& f) {
+       f.operationSlug = QStringLiteral("op-5");
+       f.contentType = QStringLiteral("image");
+     })},
+  };
+  return cases;
+}
+
+void Bench::benchFilters(DatabaseConnection& db, qint64 dbRows)
+{
+  for (const auto& filterCase : filterCases()) {
+    const auto filters = filterCase.second;
+    measure(QStringLiteral("getEvidenceWithFilters[%1]").arg(filterCase.first), dbRows, 3, [&db, filters] {
+      return qint64(db.getEvidenceWithFilters(filters).size());
+    });
+  }
+}
+
+void Bench::checkFilterPlans(const QString& connectionName, qint64 dbRows)
+{
+  // a read of every row, as opposed to a search of (or an ordered walk through) an index
+  static const QRegularExpression tableScan(QStringLiteral("^SCAN (TABLE )?evidence( AS \\w+)?$"));
+  static const QRegularExpression epochIndex(QStringLiteral("USING (COVERING )?INDEX evidence_\\w+_ms_idx"));
+  // a text search is driven by the search index (then sorted); every other filter walks an epoch index
+  static const QStringList searchCases{QStringLiteral("text")};
+  QSqlQuery plan(QSqlDatabase::database(connectionName));
+  for (const auto& filterCase : filterCases()) {
+    // both the first page, and a following page, as the evidence list reads them
+    for (const auto& after : {EvidencePageKey(), EvidencePageKey{1, 1}}) {
+      auto dbQuery = DatabaseConnection::buildGetEvidenceWithFiltersQuery(filterCase.second, after, 100);
+      plan.prepare(QStringLiteral("EXPLAIN QUERY PLAN %1").arg(dbQuery.query()));
+      for (const auto& value : dbQuery.values())
+        plan.addBindValue(value);
+      if (!plan.exec()) {
+        _planFailures.append(QStringLiteral("%1 @ %2 rows: %3")
+                                 .arg(filterCase.first).arg(dbRows).arg(plan.lastError().text()));
+        continue;
+      }
+      auto caseName = QStringLiteral("%1%2 @ %3 rows")
+          .arg(filterCase.first, after.isValid() ? QStringLiteral(" (next page)") : QString()).arg(dbRows);
+      // the plan's columns are id, parent, notused and detail
+      QStringList details;
+      while (plan.next()) {
+        auto detail = plan.value(3).toString();
+        details.append(detail);
+        if (tableScan.match(detail).hasMatch())
+          _planFailures.append(QStringLiteral("%1: scans the evidence table: %2").arg(caseName, detail));
+      }
+      bool usesEpochIndex = std::any_of(details.cbegin(), details.cend(), [](const QString& detail) {
+        return epochIndex.match(detail).hasMatch();
+      });
+      if (!usesEpochIndex && !searchCases.contains(filterCase.first)) {
+        _planFailures.append(QStringLiteral("%1: does not use an epoch index: %2")
+                                 .arg(caseName, details.join(QStringLiteral("; "))));
+      }
+    }
+  }
+}
+
+void Bench::benchTags(DatabaseConnection& db, qint64 dbRows)
+{
+  const int calls = 500;
+  QList<qint64> targets;
+  for (int i = 0; i < calls; i++)
+    targets.append(qint64(_random.bounded(quint64(dbRows))) + 1);
+
+  int call = 0;
+  measure(QStringLiteral("setEvidenceTags"), dbRows, calls, [&] {
+    QList<model::Tag> tags;
+    auto count = 1 + call % 4;
+    for (int t = 0; t < count; t++) {
+      auto serverTagID = (call + t * 7) % serverTagCount + 1;
+      tags.append(model::Tag(serverTagID, QStringLiteral("tag-%1").arg(serverTagID)));
+    }
+    db.setEvidenceTags(tags, targets.at(call++));
+    return qint64(tags.size());
+  });
+
+  QList<qint64> batch;
+  for (int i = 0; i < 1000; i++)
+    batch.append(qint64(_random.bounded(quint64(dbRows))) + 1);
+  measure(QStringLiteral("getFullTagsForEvidenceIDs[1000]"), dbRows, 20, [&db, &batch] {
+    return qint64(db.getFullTagsForEvidenceIDs(batch).size());
+  });
+
+  measure(QStringLiteral("createEvidence"), dbRows, calls, [&db] {
+    return db.createEvidence(QStringLiteral("/evidence/op-1/new.png"), QStringLiteral("op-1"),
+                             QStringLiteral("image")) == -1 ? 0 : 1;
+  });
+}
+
+void Bench::benchDecode(const QString& connectionName, qint64 dbRows)
+{
+  // compares the column-position decoder with looking each column up by name for every row
+  const auto stmt = QStringLiteral("SELECT id, path, operation_slug, content_type, description, error,"
+                                   " recorded_date, upload_date, recorded_ms, upload_ms FROM evidence");
+  auto sqlDb = QSqlDatabase::database(connectionName);
+  measure(QStringLiteral("decode[by_position]"), dbRows, 3, [&] {
+    QSqlQuery query(sqlDb);
+    query.setForwardOnly(true);
+    query.exec(stmt);
+    EvidenceRowDecoder decoder(query);
+    qint64 rows = 0;
+    while (query.next()) {
+      auto evi = decoder.decode(query);
+      rows += evi.id > 0;
+    }
+    return rows;
+  });
+  measure(QStringLiteral("decode[by_name]"), dbRows, 3, [&] {
+    QSqlQuery query(sqlDb);
+    query.setForwardOnly(true);
+    query.exec(stmt);
+    qint64 rows = 0;
+    while (query.next()) {
+      model::Evidence evi;
+      evi.id = query.value(QStringLiteral("id")).toLongLong();
+      evi.path = query.value(QStringLiteral("path")).toString();
+      evi.operationSlug = query.value(QStringLiteral("operation_slug")).toString();
+      evi.contentType = query.value(QStringLiteral("content_type")).toString();
+      evi.description = query.value(QStringLiteral("description")).toString();
+      evi.errorText = query.value(QStringLiteral("error")).toString();
+      evi.recordedDate = QDateTime::fromMSecsSinceEpoch(query.value(QStringLiteral("recorded_ms")).toLongLong(), Qt::UTC);
+      auto uploadMs = query.value(QStringLiteral("upload_ms"));
+      if (!uploadMs.isNull())
+        evi.uploadDate = QDateTime::fromMSecsSinceEpoch(uploadMs.toLongLong(), Qt::UTC);
+      rows += evi.id > 0;
+    }
+    return rows;
+  });
+}
+
+bool Bench::buildLegacyDb(const QString& path, qint64 dbRows)
+{
+  // a legacy db has only the migrations that predate the optimized schema, and data in that shape
+  const auto name = QStringLiteral("bench_legacy");
+  bool ok = true;
+  {
+    auto db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), name);
+    db.setDatabaseName(path);
+    if (!db.open())
+      return false;
+    QSqlQuery query(db);
+    auto migrations = QDir(QStringLiteral(":/migrations")).entryList({QStringLiteral("*.sql")}, QDir::Files, QDir::Name);
+    for (const auto& migration : migrations) {
+      if (migration >= legacyMigrationCutoff)
+        break;
+      QFile file(QStringLiteral(":/migrations/%1").arg(migration));
+      if (!file.open(QIODevice::ReadOnly))
+        return false;
+      auto content = QString::fromUtf8(file.readAll());
+      auto up = content.indexOf(QStringLiteral("-- +migrate up"), 0, Qt::CaseInsensitive);
+      auto upEnd = content.indexOf(QLatin1Char('\n'), up);
+      auto down = content.indexOf(QStringLiteral("-- +migrate down"), 0, Qt::CaseInsensitive);
+      auto script = content.mid(upEnd, down - upEnd).trimmed();
+      // data migrations take an id range; the legacy db is still empty, so one range covers it
+      bool batched = content.mid(up, upEnd - up).contains(QStringLiteral("batch"), Qt::CaseInsensitive);
+      ok = ok && query.prepare(script);
+      if (batched) {
+        query.addBindValue(0);
+        query.addBindValue(std::numeric_limits<qint64>::max());
+      }
+      ok = ok && query.exec();
+      query.prepare(QStringLiteral("INSERT INTO migrations (migration_name, applied_at) VALUES (?, datetime('now'))"));
+      query.addBindValue(migration);
+      ok = ok && query.exec();
+    }
+
+    db.transaction();
+    query.prepare(QStringLiteral("INSERT INTO evidence (id, path, operation_slug, content_type, description,"
+                                 " error, recorded_date, upload_date) VALUES (?, ?, ?, ?, ?, ?, ?, ?)"));
+    QSqlQuery tagQuery(db);
+    tagQuery.prepare(QStringLiteral("INSERT INTO tags (evidence_id, tag_id, name) VALUES (?, ?, ?)"));
+    for (qint64 id = 1; ok && id <= dbRows; id++) {
+      auto evi = syntheticEvidence(id);
+      for (const auto& value : QVariantList{evi.id, evi.path, evi.operationSlug, evi.contentType,
+                                            evi.description, evi.errorText, evi.recordedDate,
+                                            evi.uploadDate.isValid() ? QVariant(evi.uploadDate) : QVariant()})
+        query.addBindValue(value);
+      ok = query.exec();
+      for (qint64 t = 0; ok && t < id % 3; t++) {
+        auto serverTagID = (id + t) % serverTagCount + 1;
+        tagQuery.addBindValue(id);
+        tagQuery.addBindValue(serverTagID);
+        tagQuery.addBindValue(QStringLiteral("tag-%1").arg(serverTagID));
+        ok = tagQuery.exec();
+      }
+    }
+    ok = db.commit() && ok;
+    if (!ok)
+      qWarning() << "Unable to build legacy db:" << query.lastError().text() << tagQuery.lastError().text();
+    db.close();
+  }
+  QSqlDatabase::removeDatabase(name);
+  return ok;
+}
+
+void Bench::benchMigrations(qint64 dbRows)
+{
+  auto timeConnect = [this, dbRows](const QString& benchName, const QString& path) {
+    bool ok = true;
+    measure(benchName, dbRows, 1, [&ok, &path] {
+      ok = DatabaseConnection::withConnection(path, QStringLiteral("bench_migrate"), [](DatabaseConnection) {});
+      return qint64(0);
+    });
+    if (!ok)
+      qWarning() << benchName << "failed";
+  };
+
+  timeConnect(QStringLiteral("migrateDB[fresh]"), dbPath(QStringLiteral("fresh"), dbRows));
+  auto legacyPath = dbPath(QStringLiteral("legacy"), dbRows);
+  if (buildLegacyDb(legacyPath, dbRows))
+    timeConnect(QStringLiteral("migrateDB[legacy]"), legacyPath);
+}
+
+void Bench::runAll(qint64 dbRows)
+{
+  benchMigrations(dbRows);
+
+  {
+    DatabaseConnection db(dbPath(QStringLiteral("bench"), dbRows), QStringLiteral("bench"));
+    if (!db.connect()) {
+      qWarning() << "Unable to open bench db:" << db.errorString();
+      return;
+    }
+    populate(db, dbRows);
+    checkFilterPlans(QStringLiteral("bench"), dbRows);
+    benchFilters(db, dbRows);
+    benchTags(db, dbRows);
+    benchDecode(QStringLiteral("bench"), dbRows);
+    db.close();
+  }
+  QSqlDatabase::removeDatabase(QStringLiteral("bench"));
+}
+
+void Bench::checkPlans(qint64 dbRows)
+{
+  {
+    DatabaseConnection db(dbPath(QStringLiteral("plans"), dbRows), QStringLiteral("plans"));
+    if (!db.connect()) {
+      _planFailures.append(QStringLiteral("Unable to open plan db: %1").arg(db.errorString()));
+      return;
+    }
+    populate(db, dbRows);
+    checkFilterPlans(QStringLiteral("plans"), dbRows);
+    db.close();
+  }
+  QSqlDatabase::removeDatabase(QStringLiteral("plans"));
+}
+
+QByteArray toJson(const QList<Result>& results)
+{
+  QJsonArray rows;
+  for (const auto& r : results) {
+    rows.append(QJsonObject{
+        {QStringLiteral("name"), r.name},
+        {QStringLiteral("dbRows"), r.dbRows},
+        {QStringLiteral("iterations"), r.iterations},
+        {QStringLiteral("totalUs"), r.totalUs},
+        {QStringLiteral("meanUs"), r.iterations ? r.totalUs / r.iterations : 0},
+        {QStringLiteral("minUs"), r.iterations ? r.minUs : 0},
+        {QStringLiteral("maxUs"), r.maxUs},
+        {QStringLiteral("rows"), r.rows},
+    });
+  }
+  QJsonObject root{
+      {QStringLiteral("qtVersion"), QString::fromLatin1(qVersion())},
+      {QStringLiteral("results"), rows},
+      {QStringLiteral("queryStats"), QJsonDocument::fromJson(DatabaseConnection::queryStats().toJson()).object()},
+  };
+  return QJsonDocument(root).toJson();
+}
+
+QByteArray toCsv(const QList<Result>& results)
+{
+  QByteArray rtn("name,db_rows,iterations,total_us,mean_us,min_us,max_us,rows\n");
+  for (const auto& r : results) {
+    rtn.append(QStringLiteral("\"%1\",%2,%3,%4,%5,%6,%7,%8\n")
+                   .arg(r.name).arg(r.dbRows).arg(r.iterations).arg(r.totalUs)
+                   .arg(r.iterations ? r.totalUs / r.iterations : 0)
+                   .arg(r.iterations ? r.minUs : 0).arg(r.maxUs).arg(r.rows)
+                   .toUtf8());
+  }
+  return rtn;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  Q_INIT_RESOURCE(res_migrations);
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName(QStringLiteral("ashirt_db_bench"));
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(QStringLiteral("Benchmarks the ashirt evidence database"));
+  parser.addHelpOption();
+  QCommandLineOption sizesOption(QStringLiteral("sizes"),
+                                 QStringLiteral("Comma separated evidence row counts to benchmark."),
+                                 QStringLiteral("sizes"), QStringLiteral("1000,100000,1000000"));
+  QCommandLineOption formatOption(QStringLiteral("format"), QStringLiteral("Output format: json or csv."),
+                                  QStringLiteral("format"), QStringLiteral("json"));
+  QCommandLineOption outOption(QStringLiteral("out"), QStringLiteral("Write results to this file instead of stdout."),
+                               QStringLiteral("file"));
+  QCommandLineOption dirOption(QStringLiteral("dir"), QStringLiteral("Directory for the benchmark databases (default: a temporary directory)."),
+                               QStringLiteral("dir"));
+  QCommandLineOption checkPlansOption(QStringLiteral("check-plans"),
+                                      QStringLiteral("Only check that the evidence filters use their indexes (no timings)."));
+  parser.addOptions({sizesOption, formatOption, outOption, dirOption, checkPlansOption});
+  parser.process(app);
+
+  QList<qint64> sizes;
+  for (const auto& size : parser.value(sizesOption).split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+    bool ok = false;
+    auto value = size.trimmed().toLongLong(&ok);
+    if (!ok || value <= 0) {
+      qCritical() << "Invalid size:" << size;
+      return 1;
+    }
+    sizes.append(value);
+  }
+  auto format = parser.value(formatOption).toLower();
+  if (format != QStringLiteral("json") && format != QStringLiteral("csv")) {
+    qCritical() << "Invalid format:" << format;
+    return 1;
+  }
+
+  QTemporaryDir tempDir;
+  auto workDir = parser.isSet(dirOption) ? parser.value(dirOption) : tempDir.path();
+  QDir().mkpath(workDir);
+  // every statement is timed below anyway, so the slow query log would only add noise
+  DatabaseConnection::queryStats().setSlowThresholdMs(-1);
+
+  Bench bench(workDir);
+  if (parser.isSet(checkPlansOption)) {
+    for (auto size : sizes)
+      bench.checkPlans(size);
+    for (const auto& failure : bench.planFailures())
+      qCritical().noquote() << "Evidence filter plan check failed:" << failure;
+    return bench.planFailures().isEmpty() ? 0 : 2;
+  }
+  for (auto size : sizes)
+    bench.runAll(size);
+
+  auto output = format == QStringLiteral("csv") ? toCsv(bench.results()) : toJson(bench.results());
+  if (parser.isSet(outOption)) {
+    QFile file(parser.value(outOption));
+    if (!file.open(QIODevice::WriteOnly) || file.write(output) == -1) {
+      qCritical() << "Unable to write" << file.fileName();
+      return 1;
+    }
+  } else {
+    QTextStream(stdout) << output;
+  }
+
+  for (const auto& failure : bench.planFailures())
+    qCritical().noquote() << "Evidence filter plan check failed:" << failure;
+  return bench.planFailures().isEmpty() ? 0 : 2;
+}
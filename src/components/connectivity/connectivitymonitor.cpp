@@ -0,0 +1,118 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#include "connectivitymonitor.h"
+
+#include <QNetworkReply>
+
+#include <algorithm>
+
+#include "helpers/cleanupreply.h"
+#include "helpers/netman.h"
+
+ConnectivityMonitor::ConnectivityMonitor(QObject* parent)
+  : QObject(parent)
+{
+  probeTimer.setSingleShot(true);
+  connect(&probeTimer, &QTimer::timeout, this, &ConnectivityMonitor::probe);
+
+  // without a backend (or permission to use it), failed requests and probes are all there is to go on
+  if (!QNetworkInformation::loadDefaultBackend()) {
+    qInfo() << "No network information backend available; relying on server probes";
+    return;
+  }
+  auto info = QNetworkInformation::instance();
+  connect(info, &QNetworkInformation::reachabilityChanged, this, &ConnectivityMonitor::onReachabilityChanged);
+  if (info->reachability() == QNetworkInformation::Reachability::Disconnected)
+    onReachabilityChanged(info->reachability());
+}
+
+ConnectivityMonitor::~ConnectivityMonitor()
+{
+  abortProbe();
+}
+
+void ConnectivityMonitor::reportResponse()
+{
+  probeDelayMs = minProbeDelayMs;
+  setOnline(true);
+}
+
+void ConnectivityMonitor::reportNoResponse()
+{
+  // while offline, the probe timer is already waiting for the server
+  if (online)
+    probe();
+}
+
+bool ConnectivityMonitor::noResponse(QNetworkReply* reply)
+{
+  return reply->error() != QNetworkReply::NoError
+         && !reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid();
+}
+
+void ConnectivityMonitor::probe()
+{
+  if (probeReply)
+    return;
+  probeTimer.stop();
+  probeReply = NetMan::checkConnection();
+  QTimer::singleShot(probeTimeoutMs, probeReply, &QNetworkReply::abort);
+  connect(probeReply, &QNetworkReply::finished, this, &ConnectivityMonitor::onProbeFinished);
+}
+
+void ConnectivityMonitor::abortProbe()
+{
+  if (!probeReply)
+    return;
+  probeReply->disconnect(this);
+  cleanUpReply(&probeReply);
+}
+
+void ConnectivityMonitor::onProbeFinished()
+{
+  // any response will do: e.g. an authorization failure still means the server is there
+  bool reachable = !noResponse(probeReply);
+  cleanUpReply(&probeReply);
+  if (reachable) {
+    reportResponse();
+    return;
+  }
+  setOnline(false);
+  scheduleProbe();
+}
+
+void ConnectivityMonitor::onReachabilityChanged(QNetworkInformation::Reachability reachability)
+{
+  switch (reachability) {
+    case QNetworkInformation::Reachability::Unknown:
+      break;
+    case QNetworkInformation::Reachability::Disconnected:
+      abortProbe();
+      setOnline(false);
+      scheduleProbe();
+      break;
+    default:
+      // the server may be on the local (or VPN) network, so only a probe can tell
+      probeDelayMs = minProbeDelayMs;
+      probe();
+      break;
+  }
+}
+
+void ConnectivityMonitor::scheduleProbe()
+{
+  probeTimer.start(probeDelayMs);
+  probeDelayMs = std::min(probeDelayMs * 2, maxProbeDelayMs);
+}
+
+void ConnectivityMonitor::setOnline(bool isOnline)
+{
+  if (online == isOnline)
+    return;
+  online = isOnline;
+  if (online)
+    probeTimer.stop();
+  qInfo() << (online ? "ASHIRT server is reachable again" : "ASHIRT server is unreachable; working offline");
+  Q_EMIT onlineChanged(online);
+}
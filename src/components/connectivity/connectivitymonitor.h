@@ -0,0 +1,69 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+#include <QNetworkInformation>
+#include <QObject>
+#include <QTimer>
+
+class QNetworkReply;
+
+/**
+ * @brief The ConnectivityMonitor class tracks whether the ASHIRT server can be reached, so that work
+ * needing the server (uploads, creating tags) can wait for it, rather than fail. The system's view
+ * of the network (QNetworkInformation) is used when a backend is available: losing the network
+ * goes offline straight away, and any other change is confirmed with a probe of the server.
+ * Requests that get no response at all are reported here, and are also confirmed with a probe.
+ * While offline, the server is probed with a growing delay until it answers.
+ */
+class ConnectivityMonitor : public QObject {
+  Q_OBJECT
+
+ public:
+  static ConnectivityMonitor* get() {
+    static ConnectivityMonitor i;
+    return &i;
+  }
+
+  /// isOnline returns true unless the server is known to be unreachable
+  bool isOnline() const { return online; }
+  /// reportResponse records that a request got a response (of any status) from the server
+  void reportResponse();
+  /// reportNoResponse records that a request got no response from the server. A probe confirms
+  /// whether the server is unreachable before going offline.
+  void reportNoResponse();
+  /// noResponse returns true if the reply failed without any response from the server (as opposed
+  /// to with an error status)
+  static bool noResponse(QNetworkReply* reply);
+
+ public Q_SLOTS:
+  /// probe checks whether the server can be reached (unless a probe is already in flight)
+  void probe();
+
+ Q_SIGNALS:
+  void onlineChanged(bool online);
+
+ private:
+  ConnectivityMonitor(QObject* parent = nullptr);
+  ConnectivityMonitor(ConnectivityMonitor const&) = delete;
+  void operator=(ConnectivityMonitor const&) = delete;
+  ~ConnectivityMonitor();
+
+  void onReachabilityChanged(QNetworkInformation::Reachability reachability);
+  void onProbeFinished();
+  /// abortProbe drops the probe in flight (if any), without reporting on it
+  void abortProbe();
+  void setOnline(bool isOnline);
+  /// scheduleProbe probes again after the current delay, and grows the delay for the next time
+  void scheduleProbe();
+
+  inline static const int probeTimeoutMs = 10000;
+  inline static const int minProbeDelayMs = 5000;
+  inline static const int maxProbeDelayMs = 2 * 60 * 1000;
+
+  bool online = true;
+  int probeDelayMs = minProbeDelayMs;
+  QNetworkReply* probeReply = nullptr;
+  QTimer probeTimer;
+};
@@ -0,0 +1,16 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+#include <QString>
+
+/// DeleteEvidenceResult summarizes the outcome of deleting a set of evidence
+struct DeleteEvidenceResult {
+  /// requested is the number of evidence items asked to be deleted
+  int requested = 0;
+  /// dbDeleteSuccess is true if the evidence was marked as deleted. Otherwise, none of the
+  /// requested evidence is deleted, and dbErrorText says why.
+  bool dbDeleteSuccess = false;
+  QString dbErrorText;
+};
@@ -7,7 +7,7 @@
 #include <QTextEdit>
 #include <QSplitter>
 #include "components/evidencepreview.h"
-#include "db/databaseconnection.h"
+#include "db/databaseworker.h"
 #include "components/aspectratio_pixmap_label/imageview.h"
 #include "components/code_editor/codeblockview.h"
 #include "components/error_view/errorview.h"
@@ -16,18 +16,18 @@
 #include "models/codeblock.h"
 #include "models/evidence.h"
 
-EvidenceEditor::EvidenceEditor(qint64 evidenceID, DatabaseConnection *db, QWidget *parent)
+EvidenceEditor::EvidenceEditor(qint64 evidenceID, DatabaseWorker *db, QWidget *parent)
     : EvidenceEditor(db, parent)
 {
   this->evidenceID = evidenceID;
   loadData();
 }
 
-EvidenceEditor::EvidenceEditor(DatabaseConnection *db, QWidget *parent)
+EvidenceEditor::EvidenceEditor(DatabaseWorker *db, QWidget *parent)
   : QWidget(parent)
   , db(db)
   , splitter(new QSplitter(this))
-  , tagEditor(new TagEditor(this))
+  , tagEditor(new TagEditor(db, this))
   , descriptionTextBox(new QTextEdit(this))
 {
   buildUi();
@@ -99,9 +99,25 @@ void EvidenceEditor::loadData()
 {
     // get local db evidence data
     clearEditor();
-    originalEvidenceData = db->getEvidenceDetails(evidenceID);
+    auto requestedID = evidenceID;
+    db->runRead([requestedID](DatabaseConnection* conn) {
+        conn->clearError();
+        auto evi = conn->getEvidenceDetails(requestedID);
+        return std::make_pair(evi, evi.id == -1 ? conn->errorString() : QString());
+    }).then(this, [this, requestedID](const std::pair<model::Evidence, QString>& loaded) {
+        if (requestedID != evidenceID)
+            return; // a different piece of evidence was requested in the meantime
+        renderEvidence(loaded.first, loaded.second);
+    });
+}
+
+void EvidenceEditor::renderEvidence(const model::Evidence& evidence, const QString& errorText)
+{
+    clearEditor();
+    originalEvidenceData = evidence;
     if(originalEvidenceData.id == -1) {
-        loadedPreview = new ErrorView(tr("Unable to load evidence: %1").arg(db->errorString()), this);
+        loadedPreview = new ErrorView(tr("Unable to load evidence: %1").arg(errorText), this);
+        splitter->insertWidget(0, loadedPreview);
         return;
     }
 
@@ -125,9 +141,14 @@ void EvidenceEditor::loadData()
 
 void EvidenceEditor::revert() {
   tagEditor->clear();
-  originalEvidenceData = db->getEvidenceDetails(evidenceID);
-  descriptionTextBox->setText(originalEvidenceData.description);
-  tagEditor->loadTags(operationSlug, originalEvidenceData.tags);
+  auto requestedID = evidenceID;
+  db->getEvidenceDetails(requestedID).then(this, [this, requestedID](const model::Evidence& evi) {
+    if (requestedID != evidenceID)
+      return;
+    originalEvidenceData = evi;
+    descriptionTextBox->setText(originalEvidenceData.description);
+    tagEditor->loadTags(operationSlug, originalEvidenceData.tags);
+  });
 }
 
 void EvidenceEditor::updateEvidence(qint64 evidenceID, bool readonly) {
@@ -157,49 +178,39 @@ void EvidenceEditor::onTagsLoaded(bool success) {
 
 // saveEvidence is a helper method to save (to the database) the currently
 // loaded evidence, using the editor changes.
-SaveEvidenceResponse EvidenceEditor::saveEvidence()
+QFuture<SaveEvidenceResponse> EvidenceEditor::saveEvidence()
 {
     if (loadedPreview != nullptr) {
         loadedPreview->saveEvidence();
     }
     auto evi = encodeEvidence();
-    auto resp = SaveEvidenceResponse(evi);
-    db->updateEvidenceDescription(evi.description, evi.id);
-    if(!db->errorString().isEmpty()) {
-        resp.actionSucceeded = false;
-        resp.errorText = db->errorString();
-        return resp;
-    }
-
-    db->setEvidenceTags(evi.tags, evi.id);
-    if(!db->errorString().isEmpty()) {
-        resp.actionSucceeded = false;
-        resp.errorText = db->errorString();
+    return db->run([evi](DatabaseConnection* conn) {
+        auto resp = SaveEvidenceResponse(evi);
+        DatabaseTransaction transaction(conn);
+        // the description and tags are saved together, or not at all
+        if (!transaction.isActive()
+            || !conn->updateEvidenceDescription(evi.description, evi.id)
+            || !conn->setEvidenceTags(evi.tags, evi.id)) {
+            resp.actionSucceeded = false;
+            resp.errorText = conn->errorString();
+            transaction.rollback();
+            return resp;
+        }
+        resp.actionSucceeded = transaction.commit();
+        if (!resp.actionSucceeded)
+            resp.errorText = conn->errorString();
         return resp;
-    }
-    resp.actionSucceeded = true;
-    return resp;
+    });
 }
 
-QList<DeleteEvidenceResponse> EvidenceEditor::deleteEvidence(QList<qint64> evidenceIDs)
+QFuture<DeleteEvidenceResult> EvidenceEditor::deleteEvidence(QList<qint64> evidenceIDs)
 {
-    QList<DeleteEvidenceResponse> responses;
-    for (qint64 id : evidenceIDs) {
-        model::Evidence evi = db->getEvidenceDetails(id);
-        DeleteEvidenceResponse resp(evi);
-        resp.dbDeleteSuccess = db->deleteEvidence(evi.id);
-        if(!resp.dbDeleteSuccess)
-            resp.errorText = db->errorString();
-
-        auto localFile = QFile(evi.path);
-        if (!localFile.remove()) {
-            resp.fileDeleteSuccess = false;
-            resp.errorText.append(QStringLiteral("\n%1").arg(localFile.errorString()));
-        } else {
-            resp.fileDeleteSuccess = true;
-        }
-        resp.errorText = resp.errorText.trimmed();
-        responses.append(resp);
-    }
-    return responses;
+    auto requested = int(evidenceIDs.size());
+    return db->deleteEvidence(evidenceIDs).then([requested](const DatabaseResult& deleted) {
+        DeleteEvidenceResult result;
+        result.requested = requested;
+        result.dbDeleteSuccess = deleted.success;
+        result.dbErrorText = deleted.errorText;
+        return result;
+    });
 }
@@ -3,38 +3,46 @@
 
 #pragma once
 
+#include <QFuture>
 #include <QWidget>
 
-#include "deleteevidenceresponse.h"
+#include "deleteevidenceresult.h"
 #include "saveevidenceresponse.h"
 
 class QSplitter;
 class QTextEdit;
 class TagEditor;
 class EvidencePreview;
-class DatabaseConnection;
+class DatabaseWorker;
 
 class EvidenceEditor : public QWidget {
   Q_OBJECT
 
  public:
-  explicit EvidenceEditor(qint64 evidenceID, DatabaseConnection* db, QWidget* parent = nullptr);
-  explicit EvidenceEditor(DatabaseConnection* db, QWidget* parent = nullptr);
+  explicit EvidenceEditor(qint64 evidenceID, DatabaseWorker* db, QWidget* parent = nullptr);
+  explicit EvidenceEditor(DatabaseWorker* db, QWidget* parent = nullptr);
   ~EvidenceEditor() = default;
 
  private:
   void buildUi();
+  /// loadData requests the current evidence from the database, and renders it once it arrives.
   void loadData();
+  /// renderEvidence populates the editor with the provided (freshly loaded) evidence, or, if it
+  /// could not be loaded, shows errorText instead
+  void renderEvidence(const model::Evidence& evidence, const QString& errorText);
   void clearEditor();
 
  public:
   model::Evidence encodeEvidence();
   void setEnabled(bool enable);
-  SaveEvidenceResponse saveEvidence();
+  /// saveEvidence writes the editor changes to the database. The returned future resolves once the
+  /// database has been updated.
+  QFuture<SaveEvidenceResponse> saveEvidence();
 
-  /// deleteEvidence is a helper method to delete both the database record and
-  /// file location of the provided evidence IDs
-  QList<DeleteEvidenceResponse> deleteEvidence(QList<qint64> evidenceIDs);
+  /// deleteEvidence is a helper method to delete the provided evidence IDs. The evidence is only
+  /// marked as deleted, which is immediate; the EvidenceCollector removes the records and files later.
+  /// The work is done off of the GUI thread.
+  QFuture<DeleteEvidenceResult> deleteEvidence(QList<qint64> evidenceIDs);
 
   /// revert re-loads the evidence to restore the content to the saved version.
   /// Only useful when used in the evidence manager.
@@ -50,7 +58,7 @@ class EvidenceEditor : public QWidget {
   void onTagsLoaded(bool success);
 
  private:
-  DatabaseConnection* db = nullptr;
+  DatabaseWorker* db = nullptr;
   qint64 evidenceID = 0;
   QString operationSlug;
   bool readonly = false;
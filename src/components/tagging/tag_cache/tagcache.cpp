@@ -2,6 +2,7 @@
 
 #include <QNetworkReply>
 
+#include "components/connectivity/connectivitymonitor.h"
 #include "helpers/netman.h"
 #include "helpers/cleanupreply.h"
 
@@ -30,6 +31,13 @@ void TagCache::requestTags(QString operationSlug) {
     if (tagRequests.find(operationSlug) != tagRequests.end()) { // message is in progress -- ignore this request
       return;
     }
+    if (!ConnectivityMonitor::get()->isOnline()) { // offline -- don't wait on the network, use what we have
+      if (entry != cache.end())
+        Q_EMIT failedLookup(operationSlug, entry->getTags());
+      else
+        Q_EMIT failedLookup(operationSlug);
+      return;
+    }
 
     auto reply = NetMan::getOperationTags(operationSlug);
     tagRequests.insert(operationSlug, reply);
@@ -60,6 +68,10 @@ void TagCache::requestTags(QString operationSlug) {
 void TagCache::onGetTagsComplete(QNetworkReply* reply, QString operationSlug) {
   bool isValid;
   auto data = NetMan::extractResponse(reply, isValid);
+  if (ConnectivityMonitor::noResponse(reply))
+    ConnectivityMonitor::get()->reportNoResponse();
+  else
+    ConnectivityMonitor::get()->reportResponse();
 
   if (isValid) {
     QList<dto::Tag> tags = dto::Tag::parseDataAsList(data);
@@ -9,14 +9,18 @@
 #include <QStringListModel>
 #include <QTimer>
 #include <algorithm>
+#include <utility>
 
+#include "components/connectivity/connectivitymonitor.h"
 #include "components/loading/qprogressindicator.h"
+#include "db/databaseworker.h"
 #include "helpers/netman.h"
 #include "helpers/cleanupreply.h"
 #include "tag_cache/tagcache.h"
 
-TagEditor::TagEditor(QWidget *parent)
+TagEditor::TagEditor(DatabaseWorker *db, QWidget *parent)
   : QWidget(parent)
+  , db(db)
   , tagView(new TagView(this))
   , errorLabel(new QLabel(this))
   , loading(new QProgressIndicator(this))
@@ -32,6 +36,8 @@ TagEditor::~TagEditor() {
   for (auto& entry : activeRequests) {
     cleanUpReply(&(entry));
   }
+  if (createTagReply)
+    createTagReply->disconnect(this);
   cleanUpReply(&createTagReply);
 }
 
@@ -123,6 +129,8 @@ void TagEditor::updateCompleterModel() {
 }
 
 void TagEditor::clear() {
+  if (createTagReply)
+    createTagReply->disconnect(this);
   cleanUpReply(&createTagReply);
   tagCompleteTextBox->clear();
   errorLabel->clear();
@@ -133,7 +141,20 @@ void TagEditor::loadTags(const QString &operationSlug, QList<model::Tag> initial
   this->operationSlug = operationSlug;
   this->initialTags = initialTags;
 
-  tagCache->requestTags(operationSlug);
+  // tags created offline are not on the server yet, so they are read from the tag outbox first
+  db->runRead([operationSlug](DatabaseConnection* conn) {
+    return conn->getPendingTags(operationSlug);
+  }).then(this, [this, operationSlug](const QList<PendingTag>& pending) {
+    if (this->operationSlug != operationSlug)
+      return;
+    pendingTags.clear();
+    for (const auto& tag : pending) {
+      dto::Tag pendingTag(tag.name, tag.colorName);
+      pendingTag.id = tag.placeholderID();
+      pendingTags.append(pendingTag);
+    }
+    tagCache->requestTags(operationSlug);
+  });
 }
 
 void TagEditor::tagsUpdated(QString operationSlug, QList<dto::Tag> tags) {
@@ -141,14 +162,9 @@ void TagEditor::tagsUpdated(QString operationSlug, QList<dto::Tag> tags) {
     clearTags();
     for (const auto& tag : tags) {
       addTag(tag);
-
-      auto itr = std::find_if(initialTags.begin(), initialTags.end(), [tag](model::Tag modelTag) {
-        return modelTag.serverTagId == tag.id;
-      });
-      if (itr != initialTags.end()) {
-        tagView->addTag(tag);
-      }
     }
+    addPendingTags();
+    showInitialTags(tags + pendingTags);
     updateCompleterModel();
     Q_EMIT tagsLoaded(true);
   }
@@ -156,16 +172,53 @@ void TagEditor::tagsUpdated(QString operationSlug, QList<dto::Tag> tags) {
 
 void TagEditor::tagsNotFound(QString operationSlug, QList<dto::Tag> outdatedTags) {
   if (this->operationSlug == operationSlug) {
-    errorLabel->setText(
-        tr("Unable to fetch tags."
-           " Please check your connection."
-           " (Tags names and colors may be incorrect)"));
-    tagCompleteTextBox->setEnabled(false);
-    // todo: factor in outdated data?
+    if (ConnectivityMonitor::get()->isOnline()) {
+      errorLabel->setText(
+          tr("Unable to fetch tags."
+             " Please check your connection."
+             " (Tags names and colors may be incorrect)"));
+    }
+    else {
+      errorLabel->setText(tr("Working offline. New tags are created once the server is reachable."));
+    }
+    // the last known tags (and those the evidence already has) stay editable
+    clearTags();
+    auto known = outdatedTags + pendingTags;
     for (const auto& tag : initialTags) {
-      tagView->addTag(dto::Tag::fromModelTag(tag, TagWidget::randomColor()));
+      bool isKnown = std::any_of(known.cbegin(), known.cend(), [&tag](const dto::Tag& knownTag) {
+        return knownTag.id == tag.serverTagId;
+      });
+      if (!isKnown) {
+        auto color = tag.colorName.isEmpty() ? TagWidget::randomColor() : tag.colorName;
+        known.append(dto::Tag::fromModelTag(tag, color));
+      }
+    }
+    for (const auto& tag : qAsConst(known)) {
+      if (!tagMap.contains(standardizeTagKey(tag.name)))
+        addTag(tag);
+    }
+    showInitialTags(known);
+    updateCompleterModel();
+    Q_EMIT tagsLoaded(true);
+  }
+}
+
+void TagEditor::addPendingTags() {
+  // a server tag with the same name takes priority; the pending tag is matched to it once created
+  for (const auto& tag : qAsConst(pendingTags)) {
+    if (!tagMap.contains(standardizeTagKey(tag.name)))
+      addTag(tag);
+  }
+}
+
+void TagEditor::showInitialTags(const QList<dto::Tag>& known) {
+  for (const auto& tag : known) {
+    auto itr = std::find_if(initialTags.begin(), initialTags.end(), [tag](model::Tag modelTag) {
+      return modelTag.serverTagId == tag.id;
+    });
+    if (itr != initialTags.end() && !tagView->contains(tag)) {
+      tagView->addTag(tag);
     }
-    Q_EMIT tagsLoaded(false);
   }
 }
 
@@ -179,13 +232,26 @@ void TagEditor::createTag(QString tagName) {
   tagCompleteTextBox->setEnabled(false);
 
   dto::Tag newTag(newText, TagWidget::randomColor());
+  if (!ConnectivityMonitor::get()->isOnline()) {
+    queueTag(newTag);
+    return;
+  }
   createTagReply = NetMan::createTag(newTag, operationSlug);
-  connect(createTagReply, &QNetworkReply::finished, this, &TagEditor::onCreateTagComplete);
+  connect(createTagReply, &QNetworkReply::finished, this, [this, newTag] {
+    onCreateTagComplete(newTag);
+  });
 }
 
-void TagEditor::onCreateTagComplete() {
+void TagEditor::onCreateTagComplete(const dto::Tag& requested) {
   bool isValid;
   auto data = NetMan::extractResponse(createTagReply, isValid);
+  bool noResponse = ConnectivityMonitor::noResponse(createTagReply);
+  if (noResponse)
+    ConnectivityMonitor::get()->reportNoResponse();
+  else
+    ConnectivityMonitor::get()->reportResponse();
+  cleanUpReply(&createTagReply);
+
   if (isValid) {
     auto newTag = dto::Tag::parseData(data);
     addTag(newTag);
@@ -193,16 +259,48 @@ void TagEditor::onCreateTagComplete() {
     tagCache->requestExpiry(this->operationSlug);
     updateCompleterModel();
   }
+  else if (noResponse) {
+    // the server could not be reached: the tag is created later instead
+    queueTag(requested);
+    return;
+  }
   else {
     QMessageBox::warning(this, tr("Tag Error"),tr("Could not create tag\n Please check your connection and try again."));
   }
-  disconnect(createTagReply, &QNetworkReply::finished, this, &TagEditor::onCreateTagComplete);
-  cleanUpReply(&createTagReply);
   loading->stopAnimation();
   tagCompleteTextBox->setEnabled(true);
   tagCompleteTextBox->setFocus();
 }
 
+void TagEditor::queueTag(const dto::Tag& tag) {
+  auto slug = operationSlug;
+  db->run([slug, tag](DatabaseConnection* conn) {
+    PendingTag pending;
+    bool queued = conn->queueTagCreation(slug, tag.name, tag.colorName, &pending);
+    return std::make_pair(queued, pending);
+  }).then(this, [this, slug](const std::pair<bool, PendingTag>& result) {
+    loading->stopAnimation();
+    tagCompleteTextBox->setEnabled(true);
+    tagCompleteTextBox->setFocus();
+    if (!result.first) {
+      QMessageBox::warning(this, tr("Tag Error"), tr("Could not save tag\n Please try again."));
+      return;
+    }
+    if (slug != operationSlug)
+      return;
+    dto::Tag pendingTag(result.second.name, result.second.colorName);
+    pendingTag.id = result.second.placeholderID();
+    if (!tagMap.contains(standardizeTagKey(pendingTag.name))) {
+      pendingTags.append(pendingTag);
+      addTag(pendingTag);
+      updateCompleterModel();
+    }
+    if (!tagView->contains(pendingTag))
+      tagView->addTag(pendingTag);
+    errorLabel->setText(tr("Tag \"%1\" will be created once the server is reachable.").arg(pendingTag.name));
+  });
+}
+
 void TagEditor::addTag(dto::Tag tag) {
   tagNames << tag.name;
   tagMap.insert(standardizeTagKey(tag.name), tag);
@@ -9,6 +9,7 @@
 #include "models/tag.h"
 
 
+class DatabaseWorker;
 class QNetworkReply;
 class QProgressIndicator;
 class QLineEdit;
@@ -17,7 +18,7 @@ class TagCache;
 class TagEditor : public QWidget {
   Q_OBJECT
  public:
-  explicit TagEditor(QWidget* parent = nullptr);
+  explicit TagEditor(DatabaseWorker* db, QWidget* parent = nullptr);
   ~TagEditor();
 
  private:
@@ -25,15 +26,22 @@ class TagEditor : public QWidget {
   void wireUi();
 
   void createTag(QString tagName);
+  /// queueTag adds the tag to the tag outbox, to be created once the server is reachable. The tag
+  /// can be used straight away (under a placeholder id).
+  void queueTag(const dto::Tag& tag);
   void updateCompleterModel();
   void tagTextEntered(QString text);
   inline void showCompleter() { completer->complete(); }
   void addTag(dto::Tag tag);
   void clearTags();
+  /// addPendingTags makes this operation's pending tags (created offline) available to pick
+  void addPendingTags();
+  /// showInitialTags shows the tags, among known, that the evidence was loaded with
+  void showInitialTags(const QList<dto::Tag>& known);
   QString standardizeTagKey(const QString &tagName);
 
  private slots:
-  void onCreateTagComplete();
+  void onCreateTagComplete(const dto::Tag& requested);
   void tagEditReturnPressed();
   void completerActivated(const QString& text);
 
@@ -47,11 +55,16 @@ class TagEditor : public QWidget {
   inline QList<model::Tag> getIncludedTags() { return tagView->getIncludedTags(); }
 
  signals:
+  /// tagsLoaded is emitted once the tags are ready to edit. When the tags cannot be fetched (e.g.
+  /// offline), they are still editable, using the last known tags.
   void tagsLoaded(bool isValid);
 
  private:
+  DatabaseWorker* db = nullptr;
   QString operationSlug;
   QList<model::Tag> initialTags;
+  /// pendingTags are this operation's tags waiting to be created on the server
+  QList<dto::Tag> pendingTags;
 
   QNetworkReply* createTagReply = nullptr;
   QMap<QString, QNetworkReply*> activeRequests;
@@ -76,7 +76,9 @@ QList<model::Tag> TagView::getIncludedTags() {
 
   for (const auto &widget : includedTags) {
     dto::Tag tag = widget->getTag();
-    rtn.append(model::Tag(tag.id, tag.name));
+    model::Tag modelTag(tag.id, tag.name);
+    modelTag.colorName = tag.colorName;
+    rtn.append(modelTag);
   }
 
   return rtn;
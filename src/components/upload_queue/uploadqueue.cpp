@@ -0,0 +1,496 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#include "uploadqueue.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QNetworkReply>
+#include <QRandomGenerator>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "appconfig.h"
+#include "components/connectivity/connectivitymonitor.h"
+#include "db/databaseworker.h"
+#include "helpers/cleanupreply.h"
+#include "helpers/http_status.h"
+#include "helpers/netman.h"
+
+UploadQueue::UploadQueue(DatabaseWorker* db, QObject* parent)
+  : QObject(parent)
+  , db(db)
+{
+  bool ok = false;
+  auto configured = AppConfig::value(CONFIG::UPLOAD_CONCURRENCY).toInt(&ok);
+  _concurrency = ok ? std::clamp(configured, 1, maxConcurrency) : defaultConcurrency;
+
+  wakeTimer.setSingleShot(true);
+  connect(&wakeTimer, &QTimer::timeout, this, &UploadQueue::pump);
+  wakeTimer.start(resumeDelayMs);
+  connect(ConnectivityMonitor::get(), &ConnectivityMonitor::onlineChanged, this, &UploadQueue::onOnlineChanged);
+
+  // anything left queued by the last session is part of the first run
+  db->run([](DatabaseConnection* conn) {
+    return conn->getQueuedUploads();
+  }).then(this, [this](const QHash<qint64, int>& attempts) {
+    QHash<qint64, UploadStatus> queued;
+    for (auto it = attempts.cbegin(); it != attempts.cend(); ++it)
+      queued.insert(it.key(), it.value() > 0 ? UploadStatus::Retrying : UploadStatus::Queued);
+    trackQueued(queued);
+  });
+}
+
+UploadQueue::~UploadQueue()
+{
+  // interrupted uploads are still queued, so they are picked up again next session
+  for (auto reply : qAsConst(inFlight)) {
+    reply->disconnect(this);
+    cleanUpReply(&reply);
+  }
+  // pending tags stay in the outbox, and are created next session
+  for (auto reply : qAsConst(tagReplies)) {
+    reply->disconnect(this);
+    cleanUpReply(&reply);
+  }
+}
+
+QFuture<DatabaseResult> UploadQueue::enqueue(const QList<qint64>& evidenceIDs)
+{
+  auto queuedIDs = std::make_shared<QList<qint64>>();
+  return db->runAction([evidenceIDs, queuedIDs](DatabaseConnection* conn) {
+    return conn->enqueueUploads(evidenceIDs, queuedIDs.get());
+  }).then(this, [this, queuedIDs](const DatabaseResult& result) {
+    if (!result.success) {
+      qWarning() << "Unable to queue evidence for upload. Error:" << result.errorText;
+      return result;
+    }
+    QHash<qint64, UploadStatus> queued;
+    for (qint64 id : qAsConst(*queuedIDs))
+      queued.insert(id, UploadStatus::Queued);
+    trackQueued(queued);
+    Q_EMIT uploadsQueued(*queuedIDs);
+    pump();
+    return result;
+  });
+}
+
+UploadQueue::RunStats UploadQueue::runStats() const
+{
+  auto rtn = run;
+  rtn.uploading = inFlight.size();
+  if (!rtn.finished)
+    rtn.elapsedMs = QDateTime::currentMSecsSinceEpoch() - runStartedMs;
+  return rtn;
+}
+
+void UploadQueue::trackQueued(const QHash<qint64, UploadStatus>& queued)
+{
+  if (queued.isEmpty())
+    return;
+  if (statuses.isEmpty()) {
+    run = RunStats();
+    run.finished = false;
+    runStartedMs = QDateTime::currentMSecsSinceEpoch();
+  }
+  for (auto it = queued.cbegin(); it != queued.cend(); ++it) {
+    auto existing = statuses.find(it.key());
+    if (existing == statuses.end()) {
+      statuses.insert(it.key(), it.value());
+      run.total++;
+    }
+    else if (*existing == UploadStatus::Retrying) {
+      *existing = it.value(); // queued again, so it is due now
+    }
+  }
+}
+
+void UploadQueue::untrack(qint64 evidenceID)
+{
+  statuses.remove(evidenceID);
+  if (statuses.isEmpty())
+    finishRun();
+}
+
+void UploadQueue::finishRun()
+{
+  if (run.finished)
+    return;
+  run.elapsedMs = QDateTime::currentMSecsSinceEpoch() - runStartedMs;
+  run.finished = true;
+}
+
+void UploadQueue::pump()
+{
+  if (fetching) {
+    pumpAgain = true;
+    return;
+  }
+  // offline: everything stays queued until the server is back (see onOnlineChanged)
+  if (!ConnectivityMonitor::get()->isOnline()) {
+    wakeTimer.stop();
+    return;
+  }
+  // a full queue still fetches, so that pending tags are created alongside the uploads
+  int freeSlots = std::max<int>(0, _concurrency - inFlight.size());
+
+  fetching = true;
+  auto exclude = inFlight.keys() + completing.values();
+  auto now = QDateTime::currentMSecsSinceEpoch();
+  db->run([now, freeSlots, exclude](DatabaseConnection* conn) {
+    DueUploads result;
+    if (freeSlots > 0)
+      result.due = conn->getDueUploads(now, freeSlots, exclude);
+    auto pending = exclude;
+    for (const auto& upload : qAsConst(result.due))
+      pending.append(upload.evidence.id);
+    result.nextAttemptMs = conn->nextUploadAttemptMs(pending);
+    result.pendingTags = conn->getPendingTags();
+    result.waitingOnTags = conn->hasUploadsWaitingOnTags();
+    return result;
+  }).then(this, [this](const DueUploads& result) {
+    fetching = false;
+    createPendingTags(result.pendingTags);
+    for (const auto& upload : result.due) {
+      // a slot freed without an upload (e.g. a missing file) is filled straight away
+      if (!startUpload(upload))
+        pumpAgain = true;
+    }
+    // pending tags held off by a failure wake the queue too
+    auto nextAttemptMs = result.nextAttemptMs;
+    if (!result.pendingTags.isEmpty() && tagRetryAtMs > QDateTime::currentMSecsSinceEpoch())
+      nextAttemptMs = nextAttemptMs < 0 ? tagRetryAtMs : std::min(nextAttemptMs, tagRetryAtMs);
+    scheduleWake(nextAttemptMs);
+    // nothing left in the database: anything still tracked was deleted while queued
+    if (result.due.isEmpty() && result.nextAttemptMs < 0 && !result.waitingOnTags && inFlight.isEmpty()
+        && completing.isEmpty() && !statuses.isEmpty()) {
+      statuses.clear();
+      finishRun();
+    }
+    if (pumpAgain) {
+      pumpAgain = false;
+      pump();
+    }
+  });
+}
+
+bool UploadQueue::startUpload(const QueuedUpload& upload)
+{
+  auto evidenceID = upload.evidence.id;
+  if (!QFile::exists(upload.evidence.path)) {
+    retryOrFail(evidenceID, upload.attempts,
+                tr("Unable to upload evidence: File not found (%1)").arg(upload.evidence.path), false, -1);
+    return false;
+  }
+
+  QString readError;
+  auto reply = NetMan::uploadAsset(upload.evidence, &readError);
+  if (!reply) {
+    // an unreadable file will not become readable by retrying
+    retryOrFail(evidenceID, upload.attempts,
+                tr("Unable to upload evidence: Unable to read file (%1)").arg(readError), false, -1);
+    return false;
+  }
+
+  if (!statuses.contains(evidenceID))
+    trackQueued({{evidenceID, UploadStatus::Uploading}});
+  statuses[evidenceID] = UploadStatus::Uploading;
+  inFlight.insert(evidenceID, reply);
+  inFlightBytes.insert(evidenceID, 0);
+  connect(reply, &QNetworkReply::uploadProgress, this, [this, evidenceID](qint64 bytesSent, qint64) {
+    auto sent = inFlightBytes.find(evidenceID);
+    if (sent == inFlightBytes.end())
+      return;
+    run.bytesSent += std::max<qint64>(0, bytesSent - *sent);
+    *sent = bytesSent;
+  });
+  connect(reply, &QNetworkReply::finished, this, [this, reply, evidenceID, attempts = upload.attempts] {
+    onUploadFinished(reply, evidenceID, attempts);
+  });
+  Q_EMIT uploadStarted(evidenceID);
+  return true;
+}
+
+void UploadQueue::onUploadFinished(QNetworkReply* reply, qint64 evidenceID, int attempts)
+{
+  inFlight.remove(evidenceID);
+  inFlightBytes.remove(evidenceID);
+  bool isValid;
+  NetMan::extractResponse(reply, isValid);
+  bool noResponse = ConnectivityMonitor::noResponse(reply);
+  if (noResponse)
+    ConnectivityMonitor::get()->reportNoResponse();
+  else
+    ConnectivityMonitor::get()->reportResponse();
+
+  if (isValid) {
+    recordCompletion(evidenceID, 1);
+  }
+  else if (noResponse && !ConnectivityMonitor::get()->isOnline()) {
+    // already known to be offline: this attempt never had a chance, so it is not counted
+    auto error = tr("Unable to upload evidence: Server unreachable (%1)").arg(reply->errorString());
+    db->runAction([evidenceID, error](DatabaseConnection* conn) {
+      return conn->deferUpload(evidenceID, error);
+    }).then(this, [this, evidenceID, error](const DatabaseResult& recorded) {
+      if (!recorded.success)
+        qWarning() << "Could not defer upload. Error:" << recorded.errorText;
+      auto status = statuses.find(evidenceID);
+      if (status != statuses.end())
+        *status = UploadStatus::Queued;
+      Q_EMIT uploadFailed(evidenceID, error, true);
+    });
+  }
+  else {
+    auto error = tr("Unable to upload evidence: Network error (%1)").arg(reply->errorString());
+    retryOrFail(evidenceID, attempts, error, isTransient(reply), retryAfterMs(reply));
+  }
+  cleanUpReply(&reply);
+  // database actions run in order, so the pump sees the outcome recorded above
+  pump();
+}
+
+void UploadQueue::recordCompletion(qint64 evidenceID, int attempt)
+{
+  // until the database agrees, the evidence is still queued there, and must not be posted again
+  completing.insert(evidenceID);
+  db->runAction([evidenceID](DatabaseConnection* conn) {
+    return conn->completeUpload(evidenceID);
+  }).then(this, [this, evidenceID, attempt](const DatabaseResult& recorded) {
+    if (!recorded.success) {
+      auto delayMs = backoffMs(attempt);
+      qWarning() << "Upload successful. Could not update internal database (retrying in" << delayMs
+                 << "ms). Error:" << recorded.errorText;
+      QTimer::singleShot(int(delayMs), this, [this, evidenceID, attempt] {
+        recordCompletion(evidenceID, attempt + 1);
+      });
+      return;
+    }
+    completing.remove(evidenceID);
+    run.succeeded++;
+    untrack(evidenceID);
+    Q_EMIT uploadSucceeded(evidenceID);
+  });
+}
+
+void UploadQueue::retryOrFail(qint64 evidenceID, int attempts, const QString& error, bool transient,
+                              qint64 requestedDelayMs)
+{
+  int failedAttempts = attempts + 1;
+  if (!transient || failedAttempts >= maxAttempts) {
+    db->runAction([evidenceID, error](DatabaseConnection* conn) {
+      return conn->failUpload(evidenceID, error);
+    }).then(this, [this, evidenceID, error](const DatabaseResult& recorded) {
+      if (!recorded.success)
+        qWarning() << "Upload failed. Could not update internal database. Error:" << recorded.errorText;
+      run.failed++;
+      untrack(evidenceID);
+      Q_EMIT uploadFailed(evidenceID, error, false);
+    });
+    return;
+  }
+
+  auto delayMs = requestedDelayMs >= 0 ? std::min(requestedDelayMs, maxRetryAfterMs) : backoffMs(failedAttempts);
+  auto nextAttemptMs = QDateTime::currentMSecsSinceEpoch() + delayMs;
+  qInfo() << "Upload of evidence" << evidenceID << "failed (attempt" << failedAttempts << "). Retrying in" << delayMs << "ms";
+  db->runAction([evidenceID, nextAttemptMs, error](DatabaseConnection* conn) {
+    return conn->retryUpload(evidenceID, nextAttemptMs, error);
+  }).then(this, [this, evidenceID, error](const DatabaseResult& recorded) {
+    if (!recorded.success)
+      qWarning() << "Could not schedule upload retry. Error:" << recorded.errorText;
+    auto status = statuses.find(evidenceID);
+    if (status != statuses.end())
+      *status = UploadStatus::Retrying;
+    Q_EMIT uploadFailed(evidenceID, error, true);
+  });
+}
+
+void UploadQueue::scheduleWake(qint64 nextAttemptMs)
+{
+  // with every slot busy, the next upload to finish pumps instead (pending tags included)
+  if (nextAttemptMs < 0 || inFlight.size() >= _concurrency) {
+    wakeTimer.stop();
+    return;
+  }
+  auto delayMs = std::clamp<qint64>(nextAttemptMs - QDateTime::currentMSecsSinceEpoch(), 0, maxRetryAfterMs);
+  wakeTimer.start(int(delayMs));
+}
+
+void UploadQueue::onOnlineChanged(bool online)
+{
+  if (!online) {
+    wakeTimer.stop();
+    return;
+  }
+  // backoff was waiting out the outage; everything queued is due now, using every slot
+  tagFailures = 0;
+  tagRetryAtMs = 0;
+  db->runAction([](DatabaseConnection* conn) {
+    return conn->resetUploadBackoff();
+  }).then(this, [this](const DatabaseResult& reset) {
+    if (!reset.success)
+      qWarning() << "Could not reset upload backoff. Error:" << reset.errorText;
+    pump();
+  });
+}
+
+void UploadQueue::createPendingTags(const QList<PendingTag>& pendingTags)
+{
+  if (QDateTime::currentMSecsSinceEpoch() < tagRetryAtMs)
+    return;
+  QHash<QString, QList<PendingTag>> byOperation;
+  for (const auto& pending : pendingTags) {
+    // an operation already being worked on is picked up again once it finishes
+    if (!tagRequestsInFlight.contains(pending.operationSlug))
+      byOperation[pending.operationSlug].append(pending);
+  }
+  for (auto it = byOperation.cbegin(); it != byOperation.cend(); ++it) {
+    auto reply = NetMan::getOperationTags(it.key());
+    trackTagReply(reply, it.key());
+    connect(reply, &QNetworkReply::finished, this, [this, reply, operationSlug = it.key(), tags = it.value()] {
+      onTagLookupFinished(reply, operationSlug, tags);
+    });
+  }
+}
+
+void UploadQueue::onTagLookupFinished(QNetworkReply* reply, const QString& operationSlug,
+                                      const QList<PendingTag>& pendingTags)
+{
+  bool isValid;
+  auto data = NetMan::extractResponse(reply, isValid);
+  if (ConnectivityMonitor::noResponse(reply))
+    ConnectivityMonitor::get()->reportNoResponse();
+  else
+    ConnectivityMonitor::get()->reportResponse();
+
+  if (!isValid) {
+    // the tags stay pending, and are tried again after a backoff
+    qWarning() << "Unable to look up tags for operation" << operationSlug << "Error:" << reply->errorString();
+    backOffPendingTags();
+  }
+  else {
+    tagFailures = 0;
+    tagRetryAtMs = 0;
+    QHash<QString, dto::Tag> serverTags;
+    const auto tags = dto::Tag::parseDataAsList(data);
+    for (const auto& tag : tags)
+      serverTags.insert(tag.name.toLower(), tag);
+
+    for (const auto& pending : pendingTags) {
+      auto existing = serverTags.find(pending.name.toLower());
+      if (existing != serverTags.end()) {
+        resolvePendingTag(pending, *existing);
+        continue;
+      }
+      auto createReply = NetMan::createTag(dto::Tag(pending.name, pending.colorName), operationSlug);
+      trackTagReply(createReply, operationSlug);
+      connect(createReply, &QNetworkReply::finished, this, [this, createReply, pending] {
+        onCreateTagFinished(createReply, pending);
+      });
+    }
+  }
+  untrackTagReply(reply, operationSlug);
+}
+
+void UploadQueue::onCreateTagFinished(QNetworkReply* reply, const PendingTag& pending)
+{
+  bool isValid;
+  auto data = NetMan::extractResponse(reply, isValid);
+  bool noResponse = ConnectivityMonitor::noResponse(reply);
+  if (noResponse)
+    ConnectivityMonitor::get()->reportNoResponse();
+  else
+    ConnectivityMonitor::get()->reportResponse();
+
+  if (isValid) {
+    resolvePendingTag(pending, dto::Tag::parseData(data));
+  }
+  else if (noResponse || isTransient(reply)) {
+    qWarning() << "Unable to create tag" << pending.name << "(will retry). Error:" << reply->errorString();
+    backOffPendingTags();
+  }
+  else {
+    // the server refused the tag; the evidence waiting on it is uploaded without it
+    auto error = reply->errorString();
+    qWarning() << "Server refused to create tag" << pending.name << "Error:" << error;
+    db->runAction([id = pending.id, error](DatabaseConnection* conn) {
+      return conn->abandonPendingTag(id, error);
+    }).then(this, [](const DatabaseResult& recorded) {
+      if (!recorded.success)
+        qWarning() << "Could not abandon pending tag. Error:" << recorded.errorText;
+    });
+  }
+  untrackTagReply(reply, pending.operationSlug);
+}
+
+void UploadQueue::resolvePendingTag(const PendingTag& pending, const dto::Tag& serverTag)
+{
+  db->runAction([id = pending.id, serverTag](DatabaseConnection* conn) {
+    return conn->resolvePendingTag(id, serverTag.id, serverTag.name, serverTag.colorName);
+  }).then(this, [name = pending.name](const DatabaseResult& recorded) {
+    if (!recorded.success)
+      qWarning() << "Could not record created tag" << name << "Error:" << recorded.errorText;
+  });
+}
+
+void UploadQueue::backOffPendingTags()
+{
+  tagFailures++;
+  tagRetryAtMs = QDateTime::currentMSecsSinceEpoch() + backoffMs(tagFailures);
+}
+
+void UploadQueue::trackTagReply(QNetworkReply* reply, const QString& operationSlug)
+{
+  tagReplies.append(reply);
+  tagRequestsInFlight[operationSlug]++;
+}
+
+void UploadQueue::untrackTagReply(QNetworkReply* reply, const QString& operationSlug)
+{
+  tagReplies.removeOne(reply);
+  cleanUpReply(&reply);
+  auto remaining = tagRequestsInFlight.find(operationSlug);
+  if (remaining != tagRequestsInFlight.end() && --(*remaining) <= 0) {
+    tagRequestsInFlight.erase(remaining);
+    // database actions run in order, so the pump sees the tags recorded above
+    pump();
+  }
+}
+
+bool UploadQueue::isTransient(QNetworkReply* reply)
+{
+  auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+  if (!status.isValid())
+    return true; // no response at all: the server (or network) may be back shortly
+  int code = status.toInt();
+  return code == HttpStatus::StatusRequestTimeout
+         || code == HttpStatus::StatusTooEarly
+         || code == HttpStatus::StatusTooManyRequests
+         || code >= HttpStatus::StatusInternalServerError;
+}
+
+qint64 UploadQueue::retryAfterMs(QNetworkReply* reply)
+{
+  // Retry-After is either a number of seconds, or an HTTP date
+  auto value = reply->rawHeader(QByteArrayLiteral("Retry-After")).trimmed();
+  if (value.isEmpty())
+    return -1;
+  bool ok = false;
+  auto seconds = value.toLongLong(&ok);
+  if (ok)
+    return std::max<qint64>(0, seconds) * 1000;
+  auto date = QDateTime::fromString(QString::fromLatin1(value), Qt::RFC2822Date);
+  if (!date.isValid())
+    return -1;
+  return std::max<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(date));
+}
+
+qint64 UploadQueue::backoffMs(int attempts)
+{
+  // exponential backoff with "equal jitter": half the delay is fixed, the other half random, so
+  // uploads that failed together do not all retry together
+  qint64 ceiling = std::min(maxBackoffMs, baseBackoffMs << std::min(attempts - 1, 20));
+  qint64 half = ceiling / 2;
+  return half + QRandomGenerator::global()->bounded(half + 1);
+}
@@ -0,0 +1,170 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+#include <QFuture>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+
+#include "db/databaseconnection.h"
+#include "db/databaseworker.h"
+#include "dtos/tag.h"
+
+class QNetworkReply;
+
+/**
+ * @brief The UploadQueue class uploads evidence in the background. Evidence is queued in the
+ * database (see DatabaseConnection::enqueueUploads), and stays queued until it is uploaded, or
+ * fails for good, so uploads carry on after a restart. Up to concurrency uploads run at once.
+ * Uploads that fail for a transient reason (a network error, a timeout, rate limiting, or a server
+ * error) are retried with exponential backoff and jitter, or after the server's Retry-After,
+ * if it sent one. Any other failure is recorded as the evidence's error.
+ *
+ * The queue also keeps the status of each queued evidence, and totals for the current run (from
+ * when the queue last became busy, until it is empty again), e.g. to show progress on a batch.
+ *
+ * The queue is also the outbox for offline work. While the ConnectivityMonitor reports the server
+ * unreachable, nothing is posted. Tags created in the meantime wait in the tag outbox (see
+ * DatabaseConnection::queueTagCreation), and evidence using them is held back until they are
+ * created. Once the server is back, every queued upload is made due, and the queue drains at full
+ * concurrency, creating pending tags (or matching them to tags created elsewhere) first.
+ */
+class UploadQueue : public QObject {
+  Q_OBJECT
+
+ public:
+  enum class UploadStatus { NotQueued, Queued, Uploading, Retrying };
+
+  /// RunStats are the totals for the current (or most recent) run
+  struct RunStats {
+    /// total is the number of evidence queued during the run
+    int total = 0;
+    int succeeded = 0;
+    int failed = 0;
+    int uploading = 0;
+    /// bytesSent counts every byte posted, including attempts that failed
+    qint64 bytesSent = 0;
+    /// elapsedMs is the length of the run so far (or of the whole run, once finished)
+    qint64 elapsedMs = 0;
+    bool finished = true;
+    qint64 bytesPerSecond() const { return elapsedMs > 0 ? bytesSent * 1000 / elapsedMs : 0; }
+  };
+
+  /// UploadQueue resumes any uploads left queued by a previous session shortly after starting.
+  /// db must outlive the queue (e.g. make db the parent).
+  UploadQueue(DatabaseWorker* db, QObject* parent = nullptr);
+  ~UploadQueue();
+
+  /// enqueue queues the given evidence for upload. Resolves to success once the evidence is queued
+  /// (in the database); the uploads themselves are reported through the signals below.
+  QFuture<DatabaseResult> enqueue(const QList<qint64>& evidenceIDs);
+  /// concurrency returns the maximum number of uploads run at once (see CONFIG::UPLOAD_CONCURRENCY)
+  int concurrency() const { return _concurrency; }
+  /// isUploading returns true if the evidence is being uploaded right now
+  bool isUploading(qint64 evidenceID) const { return inFlight.contains(evidenceID); }
+  /// uploadStatus returns where the evidence is in the queue
+  UploadStatus uploadStatus(qint64 evidenceID) const { return statuses.value(evidenceID, UploadStatus::NotQueued); }
+  /// isBusy returns true while anything is queued
+  bool isBusy() const { return !statuses.isEmpty(); }
+  RunStats runStats() const;
+
+ public Q_SLOTS:
+  /// pump starts as many due uploads as there are free slots, then waits for the next to fall due
+  void pump();
+
+ Q_SIGNALS:
+  /// uploadsQueued is emitted after enqueue, with the evidence that was queued (evidence that was
+  /// already submitted is not)
+  void uploadsQueued(const QList<qint64>& evidenceIDs);
+  void uploadStarted(qint64 evidenceID);
+  void uploadSucceeded(qint64 evidenceID);
+  /// uploadFailed is emitted when an attempt fails. When willRetry is false, the evidence has been
+  /// removed from the queue, and error recorded on it.
+  void uploadFailed(qint64 evidenceID, const QString& error, bool willRetry);
+
+ private:
+  /// DueUploads is read from the database on each pump
+  struct DueUploads {
+    QList<QueuedUpload> due;
+    qint64 nextAttemptMs = -1;
+    /// pendingTags are the tags waiting to be created on the server
+    QList<PendingTag> pendingTags;
+    /// waitingOnTags is true if any queued evidence is held back by a pending tag
+    bool waitingOnTags = false;
+  };
+
+  /// trackQueued records the status of newly queued evidence, starting a new run if the queue was idle
+  void trackQueued(const QHash<qint64, UploadStatus>& queued);
+  /// untrack forgets finished evidence, finishing the run once nothing is left
+  void untrack(qint64 evidenceID);
+  void finishRun();
+
+  /// startUpload posts the evidence. Returns false if it could not be posted (and so has already failed)
+  bool startUpload(const QueuedUpload& upload);
+  void onUploadFinished(QNetworkReply* reply, qint64 evidenceID, int attempts);
+  /// recordCompletion marks the uploaded evidence submitted, retrying (with backoff) until the
+  /// database write succeeds. uploadSucceeded is only emitted once it has.
+  void recordCompletion(qint64 evidenceID, int attempt);
+  /// retryOrFail schedules another attempt, unless the failure is permanent or the attempts have run out
+  void retryOrFail(qint64 evidenceID, int attempts, const QString& error, bool transient, qint64 requestedDelayMs);
+  /// scheduleWake sets the wake timer for the next upload to fall due (-1 for none)
+  void scheduleWake(qint64 nextAttemptMs);
+  void onOnlineChanged(bool online);
+
+  /// createPendingTags creates the pending tags on the server, one operation at a time: the
+  /// operation's tags are looked up first, so that a tag created elsewhere in the meantime is reused
+  void createPendingTags(const QList<PendingTag>& pendingTags);
+  void onTagLookupFinished(QNetworkReply* reply, const QString& operationSlug, const QList<PendingTag>& pendingTags);
+  void onCreateTagFinished(QNetworkReply* reply, const PendingTag& pending);
+  void resolvePendingTag(const PendingTag& pending, const dto::Tag& serverTag);
+  /// backOffPendingTags holds off creating pending tags after a failed request
+  void backOffPendingTags();
+  /// trackTagReply keeps the reply for a pending tag request, so it can be aborted on shutdown
+  void trackTagReply(QNetworkReply* reply, const QString& operationSlug);
+  /// untrackTagReply forgets a finished pending tag request. Once the operation has nothing left in
+  /// flight, the queue pumps again, so that evidence waiting on its tags can be uploaded.
+  void untrackTagReply(QNetworkReply* reply, const QString& operationSlug);
+
+  /// isTransient returns true if the reply failed for a reason that may clear up on its own
+  static bool isTransient(QNetworkReply* reply);
+  /// retryAfterMs returns the delay requested by the reply's Retry-After header, or -1 if none was given
+  static qint64 retryAfterMs(QNetworkReply* reply);
+  /// backoffMs returns the delay before the next attempt, after the given number of failed attempts
+  static qint64 backoffMs(int attempts);
+
+  inline static const int defaultConcurrency = 3;
+  inline static const int maxConcurrency = 16;
+  inline static const int maxAttempts = 12;
+  inline static const qint64 baseBackoffMs = 2000;
+  inline static const qint64 maxBackoffMs = 15 * 60 * 1000;
+  /// maxRetryAfterMs bounds how long a server's Retry-After can hold off an upload
+  inline static const qint64 maxRetryAfterMs = 60 * 60 * 1000;
+  /// resumeDelayMs leaves startup alone before resuming uploads from a previous session
+  inline static const int resumeDelayMs = 5000;
+
+  DatabaseWorker* db = nullptr;
+  int _concurrency = defaultConcurrency;
+  /// inFlight maps the evidence being uploaded to its reply
+  QHash<qint64, QNetworkReply*> inFlight;
+  /// completing holds the uploaded evidence whose completion is not yet recorded in the database
+  QSet<qint64> completing;
+  /// inFlightBytes is the number of bytes each upload in flight has posted so far
+  QHash<qint64, qint64> inFlightBytes;
+  /// statuses holds every evidence known to be queued (including those in flight)
+  QHash<qint64, UploadStatus> statuses;
+  RunStats run;
+  qint64 runStartedMs = 0;
+  QTimer wakeTimer;
+  /// tagReplies holds the pending tag requests in flight; tagRequestsInFlight counts them per operation
+  QList<QNetworkReply*> tagReplies;
+  QHash<QString, int> tagRequestsInFlight;
+  /// tagFailures counts the pending tag requests failed in a row; none are made before tagRetryAtMs
+  int tagFailures = 0;
+  qint64 tagRetryAtMs = 0;
+  /// fetching is true while a pump is reading due uploads; pumpAgain asks it to pump once more
+  bool fetching = false;
+  bool pumpAgain = false;
+};
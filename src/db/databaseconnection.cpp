@@ -3,10 +3,19 @@
 
 #include "databaseconnection.h"
 
+#include <QCryptographicHash>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSet>
 #include <QVariant>
 
+#include <algorithm>
+#include <iterator>
+#include <optional>
+
 #include "helpers/file_helpers.h"
+#include "models/codeblock.h"
 
 DatabaseConnection::DatabaseConnection(const QString& dbPath, const QString& databaseName)
  : _dbName(databaseName)
@@ -21,9 +30,22 @@ DatabaseConnection::DatabaseConnection(const QString& dbPath, const QString& dat
 
 bool DatabaseConnection::withConnection(const QString& dbPath, const QString &dbName,
                                         const std::function<void(DatabaseConnection)> &actions)
+{
+    return withConnection(dbPath, dbName, actions, false);
+}
+
+bool DatabaseConnection::withReadOnlyConnection(const QString& dbPath, const QString &dbName,
+                                                const std::function<void(DatabaseConnection)> &actions)
+{
+    return withConnection(dbPath, dbName, actions, true);
+}
+
+bool DatabaseConnection::withConnection(const QString& dbPath, const QString &dbName,
+                                        const std::function<void(DatabaseConnection)> &actions,
+                                        bool readOnly)
 {
     DatabaseConnection conn(dbPath, dbName);
-    if(!conn.connect())
+    if(!(readOnly ? conn.connectReadOnly() : conn.connect()))
         return false;
     actions(conn);
     bool rtn = true;
@@ -35,41 +57,139 @@ bool DatabaseConnection::withConnection(const QString& dbPath, const QString &db
     return rtn;
 }
 
-bool DatabaseConnection::connect()
+void DatabaseConnection::close() noexcept
+{
+    auto stats = _statements->stats();
+    if (stats.hits + stats.misses > 0) {
+        qInfo() << "Database" << _dbName << "statement cache: hits:" << stats.hits
+                << "misses:" << stats.misses << "evictions:" << stats.evictions;
+    }
+    _statements->clear();
+    _db.close();
+}
+
+bool DatabaseConnection::connect(const MigrationProgressCallback &onMigrationProgress)
+{
+    if (!_db.open())
+        return false;
+    // auto_vacuum can only be chosen before the first table is created (and before the journal
+    // mode is set), so only new databases use it. Existing databases keep their setting, as
+    // changing it means a full VACUUM.
+    auto schema = executeQueryNoThrow(QStringLiteral("SELECT count(*) FROM sqlite_master"), {}, false);
+    bool isNew = schema.success && schema.query->next() && schema.query->value(0).toInt() == 0;
+    schema.query.reset();
+    if (isNew && !executeQueryNoThrow(QStringLiteral("PRAGMA auto_vacuum = INCREMENTAL"), {}, false).success)
+        qWarning() << "Unable to set auto_vacuum for new database" << _dbName;
+    applyPragmas(false);
+    return migrateDB(onMigrationProgress);
+}
+
+bool DatabaseConnection::connectReadOnly()
 {
+    _db.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
     if (!_db.open())
         return false;
-    return migrateDB();
+    applyPragmas(true);
+    return true;
+}
+
+void DatabaseConnection::applyPragmas(bool readOnly)
+{
+    const SqlitePragmas defaults;
+    auto pickOption = [](const QString &value, const QStringList &options, const QString &fallback,
+                         const QString &pragma) {
+        auto upper = value.trimmed().toUpper();
+        if (options.contains(upper))
+            return upper;
+        qWarning() << "Invalid value for pragma" << pragma << ":" << value << "using" << fallback;
+        return fallback;
+    };
+
+    // pragmas cannot be bound, so every value is validated (or numeric) before formatting
+    QStringList statements {
+        QStringLiteral("PRAGMA journal_mode = %1").arg(pickOption(
+            _pragmas.journalMode,
+            {QStringLiteral("DELETE"), QStringLiteral("TRUNCATE"), QStringLiteral("PERSIST"),
+             QStringLiteral("MEMORY"), QStringLiteral("WAL"), QStringLiteral("OFF")},
+            defaults.journalMode, QStringLiteral("journal_mode"))),
+        QStringLiteral("PRAGMA synchronous = %1").arg(pickOption(
+            _pragmas.synchronous,
+            {QStringLiteral("OFF"), QStringLiteral("NORMAL"), QStringLiteral("FULL"), QStringLiteral("EXTRA")},
+            defaults.synchronous, QStringLiteral("synchronous"))),
+        QStringLiteral("PRAGMA mmap_size = %1").arg(std::max<qint64>(0, _pragmas.mmapSize)),
+        QStringLiteral("PRAGMA cache_size = %1").arg(_pragmas.cacheSize),
+        QStringLiteral("PRAGMA temp_store = %1").arg(pickOption(
+            _pragmas.tempStore,
+            {QStringLiteral("DEFAULT"), QStringLiteral("FILE"), QStringLiteral("MEMORY")},
+            defaults.tempStore, QStringLiteral("temp_store"))),
+        QStringLiteral("PRAGMA busy_timeout = %1").arg(std::max<qint64>(0, _pragmas.busyTimeout)),
+    };
+    // the journal mode is stored in the database file, so only the writer sets it
+    if (readOnly)
+        statements.removeFirst();
+    for (const auto &stmt : statements) {
+        auto result = executeQueryNoThrow(stmt, {}, false);
+        if (!result.success)
+            qWarning() << "Unable to apply" << stmt << ":" << result.err.text();
+    }
+
+    const QStringList pragmaNames {
+        QStringLiteral("journal_mode"), QStringLiteral("synchronous"), QStringLiteral("mmap_size"),
+        QStringLiteral("cache_size"), QStringLiteral("temp_store"), QStringLiteral("busy_timeout"),
+    };
+    QStringList effective;
+    for (const auto &name : pragmaNames) {
+        auto result = executeQueryNoThrow(QStringLiteral("PRAGMA %1").arg(name), {}, false);
+        if (!result.success || !result.query->first())
+            continue;
+        auto value = result.query->value(0).toString();
+        effective.append(QStringLiteral("%1=%2").arg(name, value));
+        if (name == QStringLiteral("journal_mode"))
+            _journalMode = value.toLower();
+    }
+    qInfo() << "Database" << _dbName << "pragmas:" << effective.join(QStringLiteral(", "));
 }
 
 qint64 DatabaseConnection::createEvidence(const QString &filepath, const QString &operationSlug, const QString &contentType)
 {
-    auto qKeys = QStringLiteral("path, operation_slug, content_type, recorded_date");
-    auto qValues = QStringLiteral("?, ?, ?, datetime('now')");
+    // the text column is still written, so exported databases remain readable by older versions
+    auto now = QDateTime::currentDateTimeUtc();
+    auto qKeys = QStringLiteral("path, operation_slug, content_type, recorded_date, recorded_ms");
+    auto qValues = QStringLiteral("?, ?, ?, ?, ?");
     auto qStr = _sqlBasicInsert.arg(_tblEvidence, qKeys, qValues);
-    return doInsert(_db, qStr, {filepath, operationSlug, contentType});
+    auto id = doInsert(qStr, {filepath, operationSlug, contentType, now, epochMs(now)});
+    if (id != -1)
+        updateSearchIndex(id);
+    return id;
 }
 
 qint64 DatabaseConnection::createFullEvidence(const model::Evidence &evidence) {
-    auto qKeys = QStringLiteral("path, operation_slug, content_type, description, error, recorded_date, upload_date");
-    auto qValues = QStringLiteral("?, ?, ?, ?, ?, ?, ?");
+    auto qKeys = QStringLiteral("path, operation_slug, content_type, description, error, recorded_date, upload_date, recorded_ms, upload_ms");
+    auto qValues = QStringLiteral("?, ?, ?, ?, ?, ?, ?, ?, ?");
     auto qStr = _sqlBasicInsert.arg(_tblEvidence, qKeys, qValues);
-    return doInsert(_db, qStr,
+    auto id = doInsert(qStr,
                   {evidence.path, evidence.operationSlug, evidence.contentType, evidence.description,
-                   evidence.errorText, evidence.recordedDate, evidence.uploadDate});
+                   evidence.errorText, evidence.recordedDate, evidence.uploadDate,
+                   epochMs(evidence.recordedDate), epochMs(evidence.uploadDate)});
+    if (id != -1)
+        updateSearchIndex(id);
+    return id;
 }
 
 void DatabaseConnection::batchCopyFullEvidence(const QList<model::Evidence> &evidence) {
+  DatabaseTransaction transaction(this);
   auto baseQuery = QStringLiteral("INSERT INTO evidence (%1) VALUES %2").arg(_evidenceAllKeys, QStringLiteral("%1"));
-  int varsPerRow = 8; // count number of "?"
+  int varsPerRow = 10; // count number of "?"
   std::function<QVariantList(int)> getItemValues = [evidence](int i){
     auto item = evidence.at(i);
     return QVariantList {
         item.id, item.path, item.operationSlug, item.contentType, item.description,
-        item.errorText, item.recordedDate, item.uploadDate
+        item.errorText, item.recordedDate, item.uploadDate,
+        epochMs(item.recordedDate), epochMs(item.uploadDate)
     };
   };
-  batchInsert(baseQuery, varsPerRow, evidence.size(), getItemValues);
+  if (batchInsert(baseQuery, varsPerRow, evidence.size(), getItemValues))
+    transaction.commit();
 }
 
 
@@ -77,18 +197,11 @@ model::Evidence DatabaseConnection::getEvidenceDetails(qint64 evidenceID)
 {
   model::Evidence rtn;
   auto qStr = QStringLiteral("%1 WHERE id=? LIMIT 1").arg(_sqlSelectTemplate.arg(_evidenceAllKeys, _tblEvidence));
-  auto query = executeQuery(_db, qStr, {evidenceID});
-  if (_db.lastError().type() == QSqlError::NoError && query.first()) {
-    rtn.id = query.value(QStringLiteral("id")).toLongLong();
-    rtn.path = query.value(QStringLiteral("path")).toString();
-    rtn.operationSlug = query.value(QStringLiteral("operation_slug")).toString();
-    rtn.contentType = query.value(QStringLiteral("content_type")).toString();
-    rtn.description = query.value(QStringLiteral("description")).toString();
-    rtn.errorText = query.value(QStringLiteral("error")).toString();
-    rtn.recordedDate = query.value(QStringLiteral("recorded_date")).toDateTime();
-    rtn.uploadDate = query.value(QStringLiteral("upload_date")).toDateTime();
-    rtn.recordedDate.setTimeSpec(Qt::UTC);
-    rtn.uploadDate.setTimeSpec(Qt::UTC);
+  auto query = executeQuery(qStr, {evidenceID});
+  if (_db.lastError().type() == QSqlError::NoError && query->first()) {
+    rtn = EvidenceRowDecoder(*query).decode(*query);
+    // release the (cached) statement, rather than leaving it active until the next use
+    query->finish();
     rtn.tags = getTagsForEvidenceID(evidenceID);
   } else {
     rtn.id = -1;
@@ -96,37 +209,512 @@ model::Evidence DatabaseConnection::getEvidenceDetails(qint64 evidenceID)
   return rtn;
 }
 
+QList<model::Evidence> DatabaseConnection::getEvidenceDetails(const QList<qint64>& evidenceIDs)
+{
+  QHash<qint64, model::Evidence> found;
+  found.reserve(evidenceIDs.size());
+  std::optional<EvidenceRowDecoder> decoder; // every batch has the same shape, so resolve once
+  batchQuery(QStringLiteral("%1 WHERE id IN (%2)").arg(_sqlSelectTemplate.arg(_evidenceAllKeys, _tblEvidence), QStringLiteral("%1")),
+      1, evidenceIDs.size(),
+      [&evidenceIDs](unsigned int index) { return QVariantList{evidenceIDs[index]}; },
+      [&found, &decoder](const QSqlQuery& row) {
+        if (!decoder)
+          decoder.emplace(row);
+        auto evi = decoder->decode(row);
+        found.insert(evi.id, evi);
+      });
+
+  const auto tags = getFullTagsForEvidenceIDs(found.keys());
+  for (const auto &tag : tags) {
+    auto evi = found.find(tag.evidenceId);
+    if (evi != found.end())
+      evi->tags.append(tag);
+  }
+
+  QList<model::Evidence> rtn;
+  rtn.reserve(evidenceIDs.size());
+  for (qint64 id : evidenceIDs) {
+    model::Evidence missing;
+    missing.id = -1;
+    rtn.append(found.value(id, missing));
+  }
+  return rtn;
+}
+
 bool DatabaseConnection::updateEvidenceDescription(const QString &newDescription, qint64 evidenceID)
 {
-    auto q = executeQuery(_db, QStringLiteral("UPDATE evidence SET description=? WHERE id=?"), {newDescription, evidenceID});
-    return (q.lastError().type() == QSqlError::NoError);
+    auto q = executeQuery(QStringLiteral("UPDATE evidence SET description=? WHERE id=?"), {newDescription, evidenceID});
+    if (q->lastError().type() != QSqlError::NoError)
+        return false;
+    // codeblock content is saved alongside the description, so both are reindexed here
+    return updateSearchIndex(evidenceID);
+}
+
+bool DatabaseConnection::updateSearchIndex(qint64 evidenceID)
+{
+    auto row = executeQuery(QStringLiteral("SELECT description, content_type, path FROM evidence WHERE id=?"), {evidenceID});
+    if (!row->first())
+        return false;
+    auto description = row->value(0).toString();
+    QVariant content; // NULL marks codeblock content as not yet indexed
+    if (row->value(1).toString() == Codeblock::contentType()) {
+        auto path = row->value(2).toString();
+        content = QFile::exists(path) ? Codeblock::readCodeblock(path).content : QString();
+        if (content.toString().isNull())
+            content = QStringLiteral("");
+    }
+    row->finish();
+
+    DatabaseTransaction transaction(this);
+    auto del = executeQuery(QStringLiteral("DELETE FROM evidence_fts WHERE rowid=?"), {evidenceID});
+    auto ins = executeQuery(QStringLiteral("INSERT INTO evidence_fts (rowid, description, content) VALUES (?, ?, ?)"),
+                            {evidenceID, description, content});
+    if (del->lastError().type() != QSqlError::NoError || ins->lastError().type() != QSqlError::NoError)
+        return false;
+    return transaction.commit();
+}
+
+void DatabaseConnection::indexPendingCodeblocks()
+{
+    QList<qint64> pending;
+    auto query = executeQuery(QStringLiteral(
+        "SELECT id FROM evidence WHERE content_type=? AND deleted_at IS NULL AND NOT EXISTS"
+        " (SELECT 1 FROM evidence_fts WHERE evidence_fts.rowid = evidence.id AND content IS NOT NULL)"),
+        {Codeblock::contentType()}, false);
+    while (query->next())
+        pending.append(query->value(0).toLongLong());
+    if (pending.isEmpty())
+        return;
+
+    qInfo() << "Indexing" << pending.size() << "codeblocks for search";
+    DatabaseTransaction transaction(this);
+    for (qint64 id : pending)
+        updateSearchIndex(id);
+    transaction.commit();
+}
+
+QString DatabaseConnection::toSearchQuery(const QString &text)
+{
+    QStringList terms;
+    const auto words = text.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    for (auto word : words) {
+        // quoting each word disables fts syntax; quotes inside a word are escaped by doubling them
+        word.replace(QLatin1Char('"'), QStringLiteral("\"\""));
+        terms.append(QStringLiteral("\"%1\"*").arg(word));
+    }
+    return terms.join(QLatin1Char(' '));
 }
 
 bool DatabaseConnection::deleteEvidence(qint64 evidenceID)
 {
-    auto q = executeQuery(_db, QStringLiteral("DELETE FROM evidence WHERE id=?"), {evidenceID});
-    return (q.lastError().type() == QSqlError::NoError);
+    return deleteEvidence(QList<qint64>{evidenceID});
+}
+
+bool DatabaseConnection::deleteEvidence(const QList<qint64>& evidenceIDs)
+{
+    return markDeleted(evidenceIDs, QStringLiteral("deleted_at IS NULL"));
+}
+
+bool DatabaseConnection::deferPurge(const QList<qint64>& evidenceIDs)
+{
+    return markDeleted(evidenceIDs, QStringLiteral("deleted_at IS NOT NULL"));
+}
+
+bool DatabaseConnection::optimize()
+{
+    // analysis_limit bounds the rows sampled per index by any ANALYZE that optimize decides to run
+    auto limitResult = executeQueryNoThrow(QStringLiteral("PRAGMA analysis_limit = %1").arg(_maintenanceAnalysisLimit), {}, false);
+    if (!limitResult.success)
+        return false;
+    limitResult.query.reset();
+    return executeQueryNoThrow(QStringLiteral("PRAGMA optimize"), {}, false).success;
+}
+
+qint64 DatabaseConnection::freeBytes()
+{
+    auto result = executeQueryNoThrow(QStringLiteral(
+        "SELECT f.freelist_count * p.page_size FROM pragma_freelist_count() AS f, pragma_page_size() AS p"));
+    if (!result.success || !result.query->next())
+        return -1;
+    auto bytes = result.query->value(0).toLongLong();
+    result.query->finish();
+    return bytes;
+}
+
+qint64 DatabaseConnection::incrementalVacuum(int maxPages)
+{
+    auto mode = executeQueryNoThrow(QStringLiteral("PRAGMA auto_vacuum"), {}, false);
+    if (!mode.success || !mode.query->next())
+        return -1;
+    bool incremental = mode.query->value(0).toInt() == _autoVacuumIncremental;
+    mode.query.reset();
+    // without incremental auto_vacuum, free pages are kept for reuse, and there is nothing to do
+    if (!incremental)
+        return 0;
+    auto before = freeBytes();
+    if (before <= 0)
+        return before;
+    auto result = executeQueryNoThrow(QStringLiteral("PRAGMA incremental_vacuum(%1)").arg(maxPages), {}, false);
+    if (!result.success)
+        return -1;
+    // pages are freed as the statement is stepped, so step it to completion
+    while (result.query->next()) {}
+    result.query.reset();
+    auto after = freeBytes();
+    return after < 0 ? -1 : before - after;
+}
+
+QStringList DatabaseConnection::listTables()
+{
+    QStringList rtn;
+    auto result = executeQueryNoThrow(QStringLiteral("SELECT name FROM sqlite_schema WHERE type = 'table' ORDER BY name"));
+    while (result.success && result.query->next())
+        rtn << result.query->value(0).toString();
+    return rtn;
+}
+
+bool DatabaseConnection::quickCheck(const QString& table, QStringList* problems)
+{
+    // pragma arguments cannot be bound, so the table name is quoted in place
+    auto quotedTable = QString(table).replace(QStringLiteral("\""), QStringLiteral("\"\""));
+    auto result = executeQueryNoThrow(QStringLiteral("PRAGMA quick_check(\"%1\")").arg(quotedTable), {}, false);
+    if (!result.success)
+        return false;
+    while (result.query->next()) {
+        auto message = result.query->value(0).toString();
+        if (message != QStringLiteral("ok"))
+            problems->append(message);
+    }
+    return true;
+}
+
+bool DatabaseConnection::markDeleted(const QList<qint64>& evidenceIDs, const QString& condition)
+{
+    DatabaseTransaction transaction(this);
+    if (!transaction.isActive())
+        return false;
+    // the timestamp is an integer, so it is safe to inline; this leaves every variable for the ids
+    auto baseQuery = QStringLiteral("UPDATE evidence SET deleted_at=%1 WHERE %2 AND id IN (%3)")
+            .arg(QString::number(QDateTime::currentMSecsSinceEpoch()), condition, QStringLiteral("%1"));
+    auto encodeID = [&evidenceIDs](unsigned int index) { return QVariantList{evidenceIDs[index]}; };
+    return batchQuery(baseQuery, 1, evidenceIDs.size(), encodeID, [](const QSqlQuery&){})
+            && transaction.commit();
+}
+
+QList<model::Evidence> DatabaseConnection::getDeletedEvidence(qint64 deletedBefore, int limit)
+{
+    QList<model::Evidence> rtn;
+    auto query = executeQuery(QStringLiteral("%1 WHERE deleted_at IS NOT NULL AND deleted_at <= ? ORDER BY deleted_at LIMIT ?")
+                                .arg(_sqlSelectTemplate.arg(_evidenceAllKeys, _tblEvidence)),
+                              {deletedBefore, limit});
+    EvidenceRowDecoder decoder(*query);
+    while (query->next())
+        rtn.append(decoder.decode(*query));
+    return rtn;
+}
+
+bool DatabaseConnection::purgeEvidence(const QList<qint64>& evidenceIDs)
+{
+    DatabaseTransaction transaction(this);
+    if (!transaction.isActive())
+        return false;
+
+    auto encodeID = [&evidenceIDs](unsigned int index) { return QVariantList{evidenceIDs[index]}; };
+    return batchQuery(QStringLiteral("DELETE FROM evidence_tags WHERE evidence_id IN (%1)"), 1, evidenceIDs.size(), encodeID, [](const QSqlQuery&){})
+            && batchQuery(QStringLiteral("DELETE FROM upload_queue WHERE evidence_id IN (%1)"), 1, evidenceIDs.size(), encodeID, [](const QSqlQuery&){})
+            && batchQuery(QStringLiteral("DELETE FROM evidence WHERE id IN (%1)"), 1, evidenceIDs.size(), encodeID, [](const QSqlQuery&){})
+            && transaction.commit();
+}
+
+bool DatabaseConnection::enqueueUploads(const QList<qint64>& evidenceIDs, QList<qint64>* queuedIDs)
+{
+    DatabaseTransaction transaction(this);
+    if (!transaction.isActive())
+        return false;
+    QList<qint64> pending;
+    auto encodeID = [&evidenceIDs](unsigned int index) { return QVariantList{evidenceIDs[index]}; };
+    bool found = batchQuery(QStringLiteral("SELECT id FROM evidence WHERE upload_date IS NULL AND deleted_at IS NULL AND id IN (%1)"),
+                            1, evidenceIDs.size(), encodeID, [&pending](const QSqlQuery& row) {
+                                pending.append(row.value(0).toLongLong());
+                            });
+    if (!found)
+        return false;
+
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    auto encodePendingID = [&pending](unsigned int index) { return QVariantList{pending[index]}; };
+    bool queued = batchInsert(QStringLiteral("INSERT INTO upload_queue (evidence_id, queued_ms) VALUES %1"
+                                             " ON CONFLICT (evidence_id) DO UPDATE SET attempts = 0,"
+                                             " next_attempt_ms = 0, last_error = NULL"),
+                              2, pending.size(), [&pending, now](unsigned int index) {
+                                  return QVariantList{pending[index], now};
+                              })
+            && batchQuery(QStringLiteral("UPDATE evidence SET error = '' WHERE id IN (%1)"), 1, pending.size(), encodePendingID, [](const QSqlQuery&){})
+            && transaction.commit();
+    if (queued && queuedIDs)
+        *queuedIDs = pending;
+    return queued;
+}
+
+QHash<qint64, int> DatabaseConnection::getQueuedUploads()
+{
+    QHash<qint64, int> rtn;
+    auto query = executeQuery(QStringLiteral("SELECT q.evidence_id, q.attempts %1").arg(_sqlQueuedUploadCondition));
+    while (query->next())
+        rtn.insert(query->value(0).toLongLong(), query->value(1).toInt());
+    return rtn;
+}
+
+QList<QueuedUpload> DatabaseConnection::getDueUploads(qint64 nowMs, int limit, const QList<qint64>& excludeIDs)
+{
+    QList<qint64> ids;
+    QHash<qint64, int> attempts;
+    auto query = executeQuery(QStringLiteral("SELECT q.evidence_id, q.attempts %1 AND q.next_attempt_ms <= ? AND NOT %2%3"
+                                             " ORDER BY q.next_attempt_ms, q.id LIMIT ?")
+                                .arg(_sqlQueuedUploadCondition, _sqlUploadWaitingOnTags,
+                                     excludeIDsCondition(QStringLiteral("q.evidence_id"), excludeIDs)),
+                              {nowMs, limit}, excludeIDs.isEmpty());
+    while (query->next()) {
+        auto id = query->value(0).toLongLong();
+        ids.append(id);
+        attempts.insert(id, query->value(1).toInt());
+    }
+    query->finish();
+
+    QList<QueuedUpload> rtn;
+    const auto evidence = getEvidenceDetails(ids);
+    for (const auto& evi : evidence) {
+        if (evi.id != -1)
+            rtn.append(QueuedUpload{evi, attempts.value(evi.id)});
+    }
+    return rtn;
+}
+
+qint64 DatabaseConnection::nextUploadAttemptMs(const QList<qint64>& excludeIDs)
+{
+    auto query = executeQuery(QStringLiteral("SELECT MIN(q.next_attempt_ms) %1 AND NOT %2%3")
+                                .arg(_sqlQueuedUploadCondition, _sqlUploadWaitingOnTags,
+                                     excludeIDsCondition(QStringLiteral("q.evidence_id"), excludeIDs)),
+                              {}, excludeIDs.isEmpty());
+    qint64 rtn = -1;
+    if (query->next() && !query->value(0).isNull())
+        rtn = query->value(0).toLongLong();
+    query->finish();
+    return rtn;
+}
+
+bool DatabaseConnection::hasUploadsWaitingOnTags()
+{
+    auto query = executeQuery(QStringLiteral("SELECT EXISTS (SELECT 1 %1 AND %2)")
+                                .arg(_sqlQueuedUploadCondition, _sqlUploadWaitingOnTags));
+    bool rtn = query->next() && query->value(0).toBool();
+    query->finish();
+    return rtn;
+}
+
+bool DatabaseConnection::completeUpload(qint64 evidenceID)
+{
+    DatabaseTransaction transaction(this);
+    if (!transaction.isActive())
+        return false;
+    auto now = QDateTime::currentDateTimeUtc();
+    return executeQueryNoThrow(QStringLiteral("DELETE FROM upload_queue WHERE evidence_id = ?"), {evidenceID}).success
+            && executeQueryNoThrow(QStringLiteral("UPDATE evidence SET error = '', upload_date = ?, upload_ms = ? WHERE id = ?"),
+                                   {now, epochMs(now), evidenceID}).success
+            && transaction.commit();
+}
+
+bool DatabaseConnection::retryUpload(qint64 evidenceID, qint64 nextAttemptMs, const QString& error)
+{
+    return executeQueryNoThrow(QStringLiteral("UPDATE upload_queue SET attempts = attempts + 1, next_attempt_ms = ?,"
+                                              " last_error = ? WHERE evidence_id = ?"),
+                               {nextAttemptMs, error, evidenceID}).success;
+}
+
+bool DatabaseConnection::failUpload(qint64 evidenceID, const QString& error)
+{
+    DatabaseTransaction transaction(this);
+    if (!transaction.isActive())
+        return false;
+    return executeQueryNoThrow(QStringLiteral("DELETE FROM upload_queue WHERE evidence_id = ?"), {evidenceID}).success
+            && executeQueryNoThrow(QStringLiteral("UPDATE evidence SET error = ? WHERE id = ?"), {error, evidenceID}).success
+            && transaction.commit();
+}
+
+bool DatabaseConnection::deferUpload(qint64 evidenceID, const QString& error)
+{
+    return executeQueryNoThrow(QStringLiteral("UPDATE upload_queue SET next_attempt_ms = 0, last_error = ? WHERE evidence_id = ?"),
+                               {error, evidenceID}).success;
+}
+
+bool DatabaseConnection::resetUploadBackoff()
+{
+    return executeQueryNoThrow(QStringLiteral("UPDATE upload_queue SET next_attempt_ms = 0")).success;
+}
+
+bool DatabaseConnection::queueTagCreation(const QString& operationSlug, const QString& name,
+                                          const QString& colorName, PendingTag* pending)
+{
+    DatabaseTransaction transaction(this);
+    if (!transaction.isActive())
+        return false;
+
+    PendingTag tag{0, operationSlug, name, colorName};
+    auto existing = executeQueryNoThrow(QStringLiteral("SELECT id, name, color FROM tag_outbox WHERE operation_slug = ?"
+                                                       " AND name = ? COLLATE NOCASE AND server_tag_id IS NULL AND abandoned = 0"),
+                                        {operationSlug, name});
+    if (!existing.success)
+        return false;
+    if (existing.query->next()) {
+        tag.id = existing.query->value(0).toLongLong();
+        tag.name = existing.query->value(1).toString();
+        tag.colorName = existing.query->value(2).toString();
+    }
+    existing.query->finish();
+    if (tag.id == 0) {
+        auto inserted = executeQueryNoThrow(QStringLiteral("INSERT INTO tag_outbox (operation_slug, name, color, queued_ms) VALUES (?, ?, ?, ?)"),
+                                            {operationSlug, name, colorName, QDateTime::currentMSecsSinceEpoch()});
+        if (!inserted.success)
+            return false;
+        tag.id = inserted.query->lastInsertId().toLongLong();
+    }
+
+    model::Tag placeholder(tag.placeholderID(), tag.name);
+    placeholder.colorName = tag.colorName;
+    if (!upsertTagDictionary({placeholder}) || !transaction.commit())
+        return false;
+    if (pending)
+        *pending = tag;
+    return true;
+}
+
+QList<PendingTag> DatabaseConnection::getPendingTags(const QString& operationSlug)
+{
+    QList<PendingTag> rtn;
+    auto stmt = QStringLiteral("SELECT id, operation_slug, name, color FROM tag_outbox"
+                               " WHERE server_tag_id IS NULL AND abandoned = 0%1 ORDER BY id");
+    auto query = operationSlug.isEmpty()
+                     ? executeQuery(stmt.arg(QString()))
+                     : executeQuery(stmt.arg(QStringLiteral(" AND operation_slug = ?")), {operationSlug});
+    while (query->next()) {
+        rtn.append(PendingTag{query->value(0).toLongLong(), query->value(1).toString(),
+                              query->value(2).toString(), query->value(3).toString()});
+    }
+    return rtn;
+}
+
+bool DatabaseConnection::resolvePendingTag(qint64 pendingID, qint64 serverTagID, const QString& name,
+                                           const QString& colorName)
+{
+    DatabaseTransaction transaction(this);
+    if (!transaction.isActive())
+        return false;
+    auto placeholderID = PendingTag{pendingID}.placeholderID();
+    model::Tag serverTag(serverTagID, name);
+    serverTag.colorName = colorName;
+
+    // When the server tag is new to the dictionary, the placeholder entry simply takes its id. When
+    // it is already known (e.g. someone else created it meanwhile), that update is ignored, and the
+    // evidence is moved over to the known entry instead (skipping evidence that already has it).
+    return executeQueryNoThrow(QStringLiteral("UPDATE OR IGNORE tag_dictionary SET server_tag_id = ? WHERE server_tag_id = ?"),
+                               {serverTagID, placeholderID}).success
+            && executeQueryNoThrow(QStringLiteral("UPDATE OR IGNORE evidence_tags"
+                                                  " SET tag_id = (SELECT id FROM tag_dictionary WHERE server_tag_id = ?)"
+                                                  " WHERE tag_id = (SELECT id FROM tag_dictionary WHERE server_tag_id = ?)"),
+                                   {serverTagID, placeholderID}).success
+            && dropDictionaryTag(placeholderID)
+            && upsertTagDictionary({serverTag})
+            && executeQueryNoThrow(QStringLiteral("UPDATE tag_outbox SET server_tag_id = ?, name = ?, color = ?, last_error = NULL"
+                                                  " WHERE id = ?"),
+                                   {serverTagID, name, colorName, pendingID}).success
+            && transaction.commit();
+}
+
+bool DatabaseConnection::abandonPendingTag(qint64 pendingID, const QString& error)
+{
+    DatabaseTransaction transaction(this);
+    if (!transaction.isActive())
+        return false;
+    return dropDictionaryTag(PendingTag{pendingID}.placeholderID())
+            && executeQueryNoThrow(QStringLiteral("UPDATE tag_outbox SET abandoned = 1, last_error = ? WHERE id = ?"),
+                                   {error, pendingID}).success
+            && transaction.commit();
+}
+
+bool DatabaseConnection::dropDictionaryTag(qint64 serverTagID)
+{
+    return executeQueryNoThrow(QStringLiteral("DELETE FROM evidence_tags WHERE tag_id ="
+                                              " (SELECT id FROM tag_dictionary WHERE server_tag_id = ?)"),
+                               {serverTagID}).success
+            && executeQueryNoThrow(QStringLiteral("DELETE FROM tag_dictionary WHERE server_tag_id = ?"), {serverTagID}).success;
+}
+
+bool DatabaseConnection::remapPlaceholderTags(QList<model::Tag>* tags)
+{
+    QList<qint64> pendingIDs;
+    for (const auto& tag : qAsConst(*tags)) {
+        if (PendingTag::isPlaceholder(tag.serverTagId))
+            pendingIDs.append(-tag.serverTagId);
+    }
+    if (pendingIDs.isEmpty())
+        return true;
+
+    // pending tags map to themselves; created tags to their server id; abandoned (or unknown) tags are dropped
+    QHash<qint64, qint64> serverIDs;
+    bool found = batchQuery(QStringLiteral("SELECT id, server_tag_id, abandoned FROM tag_outbox WHERE id IN (%1)"),
+                            1, pendingIDs.size(),
+                            [&pendingIDs](unsigned int index) { return QVariantList{pendingIDs[index]}; },
+                            [&serverIDs](const QSqlQuery& row) {
+                                auto pending = PendingTag{row.value(0).toLongLong()};
+                                if (row.value(2).toBool())
+                                    return;
+                                serverIDs.insert(pending.placeholderID(), row.value(1).isNull()
+                                                 ? pending.placeholderID() : row.value(1).toLongLong());
+                            });
+    if (!found)
+        return false;
+
+    QList<model::Tag> remapped;
+    for (auto tag : qAsConst(*tags)) {
+        if (PendingTag::isPlaceholder(tag.serverTagId)) {
+            auto serverID = serverIDs.find(tag.serverTagId);
+            if (serverID == serverIDs.end())
+                continue;
+            tag.serverTagId = *serverID;
+        }
+        remapped.append(tag);
+    }
+    *tags = remapped;
+    return true;
+}
+
+QString DatabaseConnection::excludeIDsCondition(const QString& column, const QList<qint64>& ids)
+{
+    if (ids.isEmpty())
+        return QString();
+    QStringList values;
+    values.reserve(ids.size());
+    for (qint64 id : ids)
+        values.append(QString::number(id));
+    return QStringLiteral(" AND %1 NOT IN (%2)").arg(column, values.join(QStringLiteral(",")));
 }
 
 bool DatabaseConnection::updateEvidenceError(const QString &errorText, qint64 evidenceID) {
-  auto q = executeQuery(_db, QStringLiteral("UPDATE evidence SET error=? WHERE id=?"), {errorText, evidenceID});
-  return (q.lastError().type() == QSqlError::NoError);
+  auto q = executeQuery(QStringLiteral("UPDATE evidence SET error=? WHERE id=?"), {errorText, evidenceID});
+  return (q->lastError().type() == QSqlError::NoError);
 }
 
 void DatabaseConnection::updateEvidenceSubmitted(qint64 evidenceID) {
-  executeQuery(_db, QStringLiteral("UPDATE evidence SET upload_date=datetime('now') WHERE id=?"), {evidenceID});
+  auto now = QDateTime::currentDateTimeUtc();
+  executeQuery(QStringLiteral("UPDATE evidence SET upload_date=?, upload_ms=? WHERE id=?"), {now, epochMs(now), evidenceID});
 }
 
 QList<model::Tag> DatabaseConnection::getTagsForEvidenceID(qint64 evidenceID) {
   QList<model::Tag> tags;
-  auto getTagQuery = executeQuery(_db, QStringLiteral("SELECT id, tag_id, name FROM tags WHERE evidence_id=?"),
+  auto getTagQuery = executeQuery(QStringLiteral("%1 WHERE et.evidence_id=?").arg(_sqlSelectEvidenceTags),
                                   {evidenceID});
-  while (getTagQuery.next()) {
-    auto tag = model::Tag(getTagQuery.value(QStringLiteral("id")).toLongLong(),
-                          getTagQuery.value(QStringLiteral("tag_id")).toLongLong(),
-                          getTagQuery.value(QStringLiteral("name")).toString());
-    tags.append(tag);
-  }
+  TagRowDecoder decoder(*getTagQuery);
+  while (getTagQuery->next())
+    tags.append(decoder.decode(*getTagQuery));
   return tags;
 }
 
@@ -134,95 +722,124 @@ QList<model::Tag> DatabaseConnection::getFullTagsForEvidenceIDs(
     const QList<qint64>& evidenceIDs) {
   QList<model::Tag> tags;
 
-  batchQuery(QStringLiteral("SELECT id, evidence_id, tag_id, name FROM tags WHERE evidence_id IN (%1)"), 1, evidenceIDs.size(),
+  batchQuery(QStringLiteral("%1 WHERE et.evidence_id IN (%2)").arg(_sqlSelectEvidenceTags, QStringLiteral("%1")), 1, evidenceIDs.size(),
       [evidenceIDs](unsigned int index){
         return QVariantList{evidenceIDs[index]};
       },
-      [&tags](const QSqlQuery& resultItem){
-        auto tag = model::Tag(resultItem.value(QStringLiteral("id")).toLongLong(),
-                              resultItem.value(QStringLiteral("evidence_id")).toLongLong(),
-                              resultItem.value(QStringLiteral("tag_id")).toLongLong(),
-                              resultItem.value(QStringLiteral("name")).toString());
-        tags.append(tag);
+      [&tags, decoder = std::optional<TagRowDecoder>()](const QSqlQuery& resultItem) mutable {
+        if (!decoder)
+          decoder.emplace(resultItem);
+        tags.append(decoder->decode(resultItem));
       });
 
   return tags;
 }
 
-bool DatabaseConnection::setEvidenceTags(const QList<model::Tag> &newTags, qint64 evidenceID)
+bool DatabaseConnection::upsertTagDictionary(const QList<model::Tag> &tags)
 {
-  if(newTags.isEmpty())
-      return false;
-
-  QVariantList newTagIds;
-  for (const auto &tag : newTags)
-    newTagIds.append(tag.serverTagId);
+  // an empty color means "unknown", so it never replaces a known color
+  auto baseQuery = QStringLiteral("INSERT INTO tag_dictionary (server_tag_id, name, color) VALUES %1"
+                                  " ON CONFLICT (server_tag_id) DO UPDATE SET name = excluded.name,"
+                                  " color = COALESCE(excluded.color, color)");
+  return batchInsert(baseQuery, 3, tags.size(), [&tags](unsigned int i) {
+    const auto& tag = tags.at(i);
+    return QVariantList{tag.serverTagId, tag.tagName,
+                        tag.colorName.isEmpty() ? QVariant() : QVariant(tag.colorName)};
+  });
+}
 
-  auto qDelStr = QStringLiteral("DELETE FROM tags WHERE tag_id NOT IN (?) AND evidence_id = ?");
-  auto a = executeQuery(_db, qDelStr, {newTagIds, evidenceID});
-  if(a.lastError().type() != QSqlError::NoError)
+bool DatabaseConnection::setEvidenceTags(const QList<model::Tag> &tags, qint64 evidenceID)
+{
+  DatabaseTransaction transaction(this);
+  if (!transaction.isActive())
       return false;
-
-  auto qSelStr = QStringLiteral("SELECT tag_id FROM tags WHERE evidence_id = ?");
-  auto currentTagsResult = executeQuery(_db, qSelStr, {evidenceID});
-  if (currentTagsResult.lastError().type() != QSqlError::NoError)
+  auto newTags = tags;
+  if (!remapPlaceholderTags(&newTags))
+      return false;
+  if (!newTags.isEmpty() && !upsertTagDictionary(newTags))
       return false;
 
-  QList<qint64> currentTags;
-  while (currentTagsResult.next())
-    currentTags.append(currentTagsResult.value(QStringLiteral("tag_id")).toLongLong());
+  auto currentTagsResult = executeQuery(
+      QStringLiteral("SELECT d.server_tag_id FROM evidence_tags AS et JOIN tag_dictionary AS d ON d.id = et.tag_id"
+                     " WHERE et.evidence_id = ?"), {evidenceID});
+  if (currentTagsResult->lastError().type() != QSqlError::NoError)
+      return false;
+  QSet<qint64> currentTags;
+  while (currentTagsResult->next())
+    currentTags.insert(currentTagsResult->value(0).toLongLong());
 
-  struct dataset {
-    qint64 evidenceID = 0;
-    qint64 tagID = 0;
-    QString name;
-  };
-  QList<dataset> tagDataToInsert;
-
-  QString baseQuery = QStringLiteral("INSERT INTO tags (evidence_id, tag_id, name) VALUES ");
-  for (const auto &newTag : newTags) {
-    if (currentTags.count(newTag.serverTagId) == 0) {
-      dataset item;
-      item.evidenceID = evidenceID;
-      item.tagID = newTag.serverTagId;
-      item.name = newTag.tagName;
-      tagDataToInsert.append(item);
+  QSet<qint64> wantedTags;
+  QList<qint64> tagsToAdd;
+  for (const auto &tag : newTags) {
+    if (!wantedTags.contains(tag.serverTagId)) {
+      wantedTags.insert(tag.serverTagId);
+      if (!currentTags.contains(tag.serverTagId))
+        tagsToAdd.append(tag.serverTagId);
     }
   }
-
-  // one possible concern: we are going to be passing a lot of parameters
-  // sqlite indicates it's default is 100 passed parameter, but it can "handle thousands"
-  if (!tagDataToInsert.empty()) {
-    QVariantList args;
-    baseQuery.append(QStringLiteral("(?,?,?)"));
-    baseQuery.append(QString(", (?,?,?)").repeated(int(tagDataToInsert.size() - 1)));
-    for (const auto &item : tagDataToInsert) {
-      args.append(item.evidenceID);
-      args.append(item.tagID);
-      args.append(item.name);
-    }
-    auto q = executeQuery(_db, baseQuery, args);
-    if (q.lastError().type() != QSqlError::NoError)
-        return false;
+  QList<qint64> tagsToRemove;
+  for (qint64 tagID : std::as_const(currentTags)) {
+    if (!wantedTags.contains(tagID))
+      tagsToRemove.append(tagID);
   }
-  return true;
+
+  // the evidence id is an integer, so it is safe to inline; this leaves every variable for the tags
+  auto noop = [](const QSqlQuery&){};
+  auto removeQuery = QStringLiteral("DELETE FROM evidence_tags WHERE evidence_id = %1 AND tag_id IN"
+                                    " (SELECT id FROM tag_dictionary WHERE server_tag_id IN (%2))")
+      .arg(QString::number(evidenceID), QStringLiteral("%1"));
+  if (!tagsToRemove.isEmpty()
+      && !batchQuery(removeQuery, 1, tagsToRemove.size(),
+                     [&tagsToRemove](unsigned int i) { return QVariantList{tagsToRemove.at(i)}; }, noop))
+      return false;
+
+  auto addQuery = QStringLiteral("INSERT INTO evidence_tags (evidence_id, tag_id)"
+                                 " SELECT %1, id FROM tag_dictionary WHERE server_tag_id IN (%2)")
+      .arg(QString::number(evidenceID), QStringLiteral("%1"));
+  if (!tagsToAdd.isEmpty()
+      && !batchQuery(addQuery, 1, tagsToAdd.size(),
+                     [&tagsToAdd](unsigned int i) { return QVariantList{tagsToAdd.at(i)}; }, noop))
+      return false;
+
+  return transaction.commit();
 }
 
 void DatabaseConnection::batchCopyTags(const QList<model::Tag> &allTags) {
-  QString baseQuery = QStringLiteral("INSERT INTO tags (id, evidence_id, tag_id, name) VALUES %1");
-  int varsPerRow = 4;
-  std::function<QVariantList(int)> getItemValues = [allTags](int i){
-    model::Tag item = allTags.at(i);
+  // pending tags are left out: their placeholder ids only mean something in the tag outbox of the
+  // database they were created in
+  QList<model::Tag> serverTags;
+  std::copy_if(allTags.begin(), allTags.end(), std::back_inserter(serverTags),
+               [](const model::Tag& tag) { return !PendingTag::isPlaceholder(tag.serverTagId); });
+  DatabaseTransaction transaction(this);
+  if (!upsertTagDictionary(serverTags))
+    return;
+  QString baseQuery = QStringLiteral("INSERT INTO evidence_tags (id, evidence_id, tag_id) VALUES %1");
+  int varsPerRow = 3;
+  std::function<QVariantList(int)> getItemValues = [serverTags](int i){
+    model::Tag item = serverTags.at(i);
+    return QVariantList{item.id, item.evidenceId, item.serverTagId};
+  };
+  auto rowTemplate = QStringLiteral("(?,?,(SELECT id FROM tag_dictionary WHERE server_tag_id = ?)),");
+  if (!batchInsert(baseQuery, varsPerRow, serverTags.size(), getItemValues, rowTemplate))
+    return;
+
+  // older versions read tags from the legacy tags table
+  std::function<QVariantList(int)> getLegacyValues = [serverTags](int i){
+    model::Tag item = serverTags.at(i);
     return QVariantList{item.id, item.evidenceId, item.serverTagId, item.tagName};
   };
-  batchInsert(baseQuery, varsPerRow, allTags.size(), getItemValues);
+  if (batchInsert(QStringLiteral("INSERT INTO tags (id, evidence_id, tag_id, name) VALUES %1"), 4,
+                  serverTags.size(), getLegacyValues))
+    transaction.commit();
 }
 
-DBQuery DatabaseConnection::buildGetEvidenceWithFiltersQuery(const EvidenceFilters &filters)
+DBQuery DatabaseConnection::buildGetEvidenceWithFiltersQuery(const EvidenceFilters &filters,
+                                                             const EvidencePageKey &after, int limit)
 {
   QString query = _sqlSelectTemplate.arg(_evidenceAllKeys, _tblEvidence);
   QVariantList values;
-  QStringList parts;
+  // tombstoned evidence is waiting to be purged, and is never shown
+  QStringList parts{QStringLiteral(" deleted_at IS NULL ")};
 
   if (filters.hasError != Tri::Any) {
     parts.append(QStringLiteral(" error LIKE ? "));
@@ -231,7 +848,7 @@ DBQuery DatabaseConnection::buildGetEvidenceWithFiltersQuery(const EvidenceFilte
   }
 
   if (filters.submitted != Tri::Any) {
-    auto sub = QStringLiteral(" upload_data IS%1NULL");
+    auto sub = QStringLiteral(" upload_date IS%1NULL");
     if(filters.submitted == Tri::Yes)
         parts.append(sub.arg(QStringLiteral(" NOT ")));
     else
@@ -246,14 +863,26 @@ DBQuery DatabaseConnection::buildGetEvidenceWithFiltersQuery(const EvidenceFilte
     parts.append(" content_type = ? ");
     values.append(filters.contentType);
   }
+  // dates are stored (and have always been compared) in UTC
   if (filters.startDate.isValid()) {
-    parts.append(" recorded_date >= ? ");
-    values.append(filters.startDate);
+    parts.append(" recorded_ms >= ? ");
+    values.append(filters.startDate.startOfDay(Qt::UTC).toMSecsSinceEpoch());
   }
   if (filters.endDate.isValid()) {
     auto realEndDate = filters.endDate.addDays(1);
-    parts.append(" recorded_date < ? ");
-    values.append(realEndDate);
+    parts.append(" recorded_ms < ? ");
+    values.append(realEndDate.startOfDay(Qt::UTC).toMSecsSinceEpoch());
+  }
+  auto searchQuery = toSearchQuery(filters.searchText);
+  if (!searchQuery.isEmpty()) {
+    parts.append(QStringLiteral(" id IN (SELECT rowid FROM evidence_fts WHERE evidence_fts MATCH ?) "));
+    values.append(searchQuery);
+  }
+  if (after.isValid()) {
+    parts.append(QStringLiteral(" (recorded_ms > ? OR (recorded_ms = ? AND id > ?)) "));
+    values.append(after.recordedMs);
+    values.append(after.recordedMs);
+    values.append(after.id);
   }
 
   if (!parts.empty()) {
@@ -261,114 +890,290 @@ DBQuery DatabaseConnection::buildGetEvidenceWithFiltersQuery(const EvidenceFilte
     for (size_t i = 1; i < parts.size(); i++)
       query.append(QStringLiteral(" AND %1").arg(parts.at(i)));
   }
+  query.append(QStringLiteral(" ORDER BY recorded_ms, id"));
+  if (limit >= 0) {
+    query.append(QStringLiteral(" LIMIT ?"));
+    values.append(limit);
+  }
   return DBQuery(query, values);
 }
 
 void DatabaseConnection::updateEvidencePath(const QString& newPath, qint64 evidenceID)
 {
-    executeQuery(_db, QStringLiteral("UPDATE evidence SET path=? WHERE id=?"), {newPath, evidenceID});
+    executeQuery(QStringLiteral("UPDATE evidence SET path=? WHERE id=?"), {newPath, evidenceID});
+}
+
+QList<qint64> DatabaseConnection::getEvidenceIDsWithFilters(const EvidenceFilters &filters)
+{
+    auto dbQuery = buildGetEvidenceWithFiltersQuery(filters);
+    auto resultSet = executeQuery(QStringLiteral("SELECT id FROM (%1)").arg(dbQuery.query()), dbQuery.values());
+    QList<qint64> rtn;
+    while (resultSet->next())
+        rtn.append(resultSet->value(0).toLongLong());
+    return rtn;
 }
 
 QList<model::Evidence> DatabaseConnection::getEvidenceWithFilters(const EvidenceFilters &filters)
 {
     auto dbQuery = buildGetEvidenceWithFiltersQuery(filters);
-    auto resultSet = executeQuery(_db, dbQuery.query(), dbQuery.values());
+    auto resultSet = executeQuery(dbQuery.query(), dbQuery.values());
     QList<model::Evidence> allEvidence;
 
-    while (resultSet.next()) {
-        model::Evidence evi;
-        evi.id = resultSet.value(QStringLiteral("id")).toLongLong();
-        evi.path = resultSet.value(QStringLiteral("path")).toString();
-        evi.operationSlug = resultSet.value(QStringLiteral("operation_slug")).toString();
-        evi.contentType = resultSet.value(QStringLiteral("content_type")).toString();
-        evi.description = resultSet.value(QStringLiteral("description")).toString();
-        evi.errorText = resultSet.value(QStringLiteral("error")).toString();
-        evi.recordedDate = resultSet.value(QStringLiteral("recorded_date")).toDateTime();
-        evi.uploadDate = resultSet.value(QStringLiteral("upload_date")).toDateTime();
-        evi.recordedDate.setTimeSpec(Qt::UTC);
-        evi.uploadDate.setTimeSpec(Qt::UTC);
-        allEvidence.append(evi);
-    }
+    EvidenceRowDecoder decoder(*resultSet);
+    while (resultSet->next())
+        allEvidence.append(decoder.decode(*resultSet));
 
     return allEvidence;
 }
 
+EvidencePage DatabaseConnection::getEvidencePage(const EvidenceFilters &filters,
+                                                 const EvidencePageKey &after, int pageSize)
+{
+    // one extra row is requested to learn whether another page follows, without another query
+    auto dbQuery = buildGetEvidenceWithFiltersQuery(filters, after, pageSize + 1);
+    auto resultSet = executeQuery(dbQuery.query(), dbQuery.values());
+    EvidencePage page;
+    page.next = after;
+    EvidenceRowDecoder decoder(*resultSet);
+    while (resultSet->next()) {
+        if (page.evidence.size() == pageSize) {
+            page.atEnd = false;
+            resultSet->finish();
+            break;
+        }
+        page.evidence.append(decoder.decode(*resultSet));
+        page.next.recordedMs = page.evidence.last().recordedDate.toMSecsSinceEpoch();
+        page.next.id = page.evidence.last().id;
+    }
+    return page;
+}
+
 QList<model::Evidence> DatabaseConnection::createEvidenceExportView(
     const QString& pathToExport, const EvidenceFilters& filters, DatabaseConnection *runningDB)
 {
     QList<model::Evidence> exportEvidence;
     auto exportViewAction = [runningDB, filters, &exportEvidence](DatabaseConnection exportDB) {
-        exportEvidence = runningDB->getEvidenceWithFilters(filters);
-        exportDB.batchCopyFullEvidence(exportEvidence);
-        QList<qint64> evidenceIds;
-        evidenceIds.resize(exportEvidence.size());
-        std::transform(exportEvidence.begin(), exportEvidence.end(), evidenceIds.begin(),
-                       [](const model::Evidence& e) { return e.id; });
-        QList<model::Tag> tags = runningDB->getFullTagsForEvidenceIDs(evidenceIds);
-        exportDB.batchCopyTags(tags);
+        // copy a page at a time, so only one page of rows (and their tags) is in flight at once
+        EvidenceCursor cursor(runningDB, filters);
+        while (!cursor.atEnd()) {
+            auto page = cursor.nextPage();
+            if (page.isEmpty())
+                break;
+            exportDB.batchCopyFullEvidence(page);
+            QList<qint64> evidenceIds;
+            evidenceIds.resize(page.size());
+            std::transform(page.begin(), page.end(), evidenceIds.begin(),
+                           [](const model::Evidence& e) { return e.id; });
+            exportDB.batchCopyTags(runningDB->getFullTagsForEvidenceIDs(evidenceIds));
+            exportEvidence.append(page);
+        }
     };
     withConnection(pathToExport, QStringLiteral("exportDB"), exportViewAction);
     return exportEvidence;
 }
 
-bool DatabaseConnection::migrateDB()
+bool DatabaseConnection::migrateDB(const MigrationProgressCallback &onProgress)
 {
+    // user_version records how many manifest migrations have been applied. When it matches the
+    // manifest, the database is current, and that single read is all startup needs to check.
+    const int targetVersion = int(migrationManifest.size());
+    auto versionResult = executeQueryNoThrow(_sqlSelectUserVersion, {}, false);
+    int currentVersion = (versionResult.success && versionResult.query->next())
+        ? versionResult.query->value(0).toInt() : 0;
+    versionResult.query.reset();
+    if (currentVersion == targetVersion)
+        return true;
+    if (currentVersion > targetVersion) {
+        qWarning() << "Database schema version" << currentVersion
+                   << "is newer than this build supports (" << targetVersion << ")";
+        return true;
+    }
+
     qInfo() << "Checking database state";
-    auto migrationsToApply = DatabaseConnection::getUnappliedMigrations();
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+    const auto migrationsToApply = DatabaseConnection::getUnappliedMigrations();
 
-    for (const auto &newMigration : migrationsToApply) {
-        QFile migrationFile(QStringLiteral("%1/%2").arg(_migrationPath, newMigration));
-        if (!migrationFile.open(QFile::ReadOnly))
+    // pending schema migrations are applied in one transaction: either they all apply, or the
+    // database is left exactly as it was. Data migrations commit a batch at a time instead, so the
+    // schema migrations before them are committed first.
+    std::optional<DatabaseTransaction> transaction;
+    for (const auto *newMigration : migrationsToApply) {
+        QElapsedTimer timer;
+        timer.start();
+        const auto migrationName = QString::fromLatin1(newMigration->name);
+        QFile migrationFile(QStringLiteral("%1/%2").arg(_migrationPath, migrationName));
+        if (!migrationFile.open(QFile::ReadOnly)) {
+            qWarning() << "Unable to read migration: " << migrationName;
             return false;
-        auto content = QString(migrationFile.readAll());
+        }
+        auto rawContent = migrationFile.readAll();
         migrationFile.close();
-        qInfo() << "Applying Migration: " << newMigration;
-        auto upScript = extractMigrateUpContent(content);
-        executeQuery(_db, upScript);
-        executeQuery(_db, _sqlAddAppliedMigration, {newMigration});
+        auto hash = QCryptographicHash::hash(rawContent, QCryptographicHash::Sha256).toHex();
+        if (hash != QByteArray(newMigration->sha256)) {
+            qWarning() << "Migration" << migrationName
+                       << "does not match the migration manifest; re-run bin/update_migration_resource.py";
+            return false;
+        }
+
+        QString options;
+        auto upScript = extractMigrateUpContent(QString(rawContent), &options);
+        bool batched = options.startsWith(_migrationOptionBatch);
+        if (onProgress)
+            onProgress(migrationName, 0);
+        if (batched) {
+            if (transaction && !transaction->commit()) {
+                qWarning() << "Unable to commit migrations: " << _db.lastError().text();
+                return false;
+            }
+            transaction.reset();
+            auto table = options.mid(_migrationOptionBatch.size()).trimmed();
+            if (!applyDataMigration(migrationName, upScript, table, onProgress))
+                return false;
+        }
+        else {
+            if (!transaction) {
+                transaction.emplace(this);
+                if (!transaction->isActive()) {
+                    qWarning() << "Unable to start migration transaction: " << _db.lastError().text();
+                    return false;
+                }
+            }
+            auto result = executeQueryNoThrow(upScript, {}, false);
+            if (!result.success) {
+                qWarning() << "Unable to apply migration" << migrationName << ": " << result.err.text();
+                return false;
+            }
+            result = executeQueryNoThrow(_sqlAddAppliedMigration, {migrationName}, false);
+            if (!result.success) {
+                qWarning() << "Unable to record migration" << migrationName << ": " << result.err.text();
+                return false;
+            }
+        }
+        if (onProgress)
+            onProgress(migrationName, 100);
+        qInfo() << "Applied Migration: " << migrationName << "in" << timer.elapsed() << "ms";
+    }
+
+    // user_version lives in the database header, so it is committed (or rolled back) along with the rest
+    if (!transaction)
+        transaction.emplace(this);
+    auto versionUpdate = executeQueryNoThrow(_sqlSetUserVersion.arg(targetVersion), {}, false);
+    if (!versionUpdate.success || !transaction->commit()) {
+        qWarning() << "Unable to commit migrations: " << _db.lastError().text();
+        return false;
+    }
+
+    qInfo() << "Applied" << migrationsToApply.size() << "migrations in" << totalTimer.elapsed() << "ms";
+    return true;
+}
+
+bool DatabaseConnection::applyDataMigration(const QString &migrationName, const QString &statement,
+                                            const QString &table, const MigrationProgressCallback &onProgress)
+{
+    // progress is the highest id processed so far. It is recorded on the migration's row, which
+    // has no applied_at until the final batch is done.
+    qint64 progress = 0;
+    auto progressResult = executeQueryNoThrow(_sqlSelectMigrationProgress, {migrationName}, false);
+    if (!progressResult.success) {
+        qWarning() << "Unable to read progress for migration" << migrationName << ": " << progressResult.err.text();
+        return false;
+    }
+    bool inProgress = progressResult.query->next();
+    if (inProgress) {
+        progress = progressResult.query->value(0).toLongLong();
+        qInfo() << "Resuming migration" << migrationName << "after id" << progress;
+    }
+    progressResult.query.reset();
+    if (!inProgress && !executeQueryNoThrow(_sqlAddMigrationInProgress, {migrationName}, false).success) {
+        qWarning() << "Unable to record migration" << migrationName << ": " << _db.lastError().text();
+        return false;
+    }
+
+    // only used to estimate progress; rows added past this point are still processed
+    auto lastIDResult = executeQueryNoThrow(QStringLiteral("SELECT MAX(id) FROM %1").arg(table), {}, false);
+    qint64 lastID = (lastIDResult.success && lastIDResult.query->next())
+        ? lastIDResult.query->value(0).toLongLong() : 0;
+    lastIDResult.query.reset();
+
+    auto batchEndQuery = QStringLiteral("SELECT MAX(id) FROM (SELECT id FROM %1 WHERE id > ? ORDER BY id LIMIT %2)")
+        .arg(table).arg(_dataMigrationBatchSize);
+    while (true) {
+        auto batchEndResult = executeQueryNoThrow(batchEndQuery, {progress});
+        if (!batchEndResult.success) {
+            qWarning() << "Unable to apply migration" << migrationName << ": " << batchEndResult.err.text();
+            return false;
+        }
+        auto batchEnd = batchEndResult.query->next() ? batchEndResult.query->value(0) : QVariant();
+        batchEndResult.query->finish();
+        if (batchEnd.isNull())
+            break;
+
+        // each batch is committed along with its progress, so an interrupted migration resumes
+        // right after the last batch it finished
+        DatabaseTransaction transaction(this);
+        auto result = executeQueryNoThrow(statement, {progress, batchEnd});
+        if (!result.success) {
+            qWarning() << "Unable to apply migration" << migrationName << ": " << result.err.text();
+            return false;
+        }
+        result = executeQueryNoThrow(_sqlUpdateMigrationProgress, {batchEnd, migrationName});
+        if (!result.success || !transaction.commit()) {
+            qWarning() << "Unable to record progress for migration" << migrationName << ": " << _db.lastError().text();
+            return false;
+        }
+        progress = batchEnd.toLongLong();
+        if (onProgress && lastID > 0)
+            onProgress(migrationName, int(std::min<qint64>(99, progress * 100 / lastID)));
     }
 
-    qInfo() << "All migrations applied";
+    if (!executeQueryNoThrow(_sqlCompleteMigration, {migrationName}, false).success) {
+        qWarning() << "Unable to record migration" << migrationName << ": " << _db.lastError().text();
+        return false;
+    }
     return true;
 }
 
-QStringList DatabaseConnection::getUnappliedMigrations()
+QList<const MigrationManifestEntry*> DatabaseConnection::getUnappliedMigrations()
 {
-    QDir migrationsDir(_migrationPath);
-    const auto allMigrations = migrationsDir.entryList(QDir::Files, QDir::Name);
-    QStringList appliedMigrations;
-    QStringList migrationsToApply;
+    QSet<QString> appliedMigrations;
+    QList<const MigrationManifestEntry*> migrationsToApply;
 
-    auto queryResult = executeQueryNoThrow(_db, _sqlSelectTemplate.arg(_migration_name, _tblMigrations));
-    QSqlQuery* dbMigrations = &queryResult.query;
-    while (queryResult.success && queryResult.query.next())
-        appliedMigrations << dbMigrations->value(_migration_name).toString();
-    // compare the two list to find gaps
-    for (const auto &possibleMigration : allMigrations) {
-        if (!possibleMigration.endsWith(QStringLiteral(".sql")))
-            continue;
-        auto foundIndex = appliedMigrations.indexOf(possibleMigration);
-        if (foundIndex == -1)
-            migrationsToApply << possibleMigration;
-        else
-            appliedMigrations.removeAt(foundIndex);
+    // on a new database, the migrations table does not exist yet, so nothing has been applied.
+    // Data migrations that are still in progress have no applied_at, and are resumed.
+    auto queryResult = executeQueryNoThrow(_sqlSelectAppliedMigrations, {}, false);
+    QSqlQuery* dbMigrations = queryResult.query.get();
+    while (queryResult.success && dbMigrations->next())
+        appliedMigrations.insert(dbMigrations->value(0).toString());
+
+    for (const auto &possibleMigration : migrationManifest) {
+        if (!appliedMigrations.remove(QString::fromLatin1(possibleMigration.name)))
+            migrationsToApply << &possibleMigration;
     }
-    if (!appliedMigrations.empty()) {
-        qWarning() << "Database is in an inconsistent state";
+    if (!appliedMigrations.isEmpty()) {
+        qWarning() << "Database is in an inconsistent state. Unknown migrations: " << appliedMigrations.values();
     }
     return migrationsToApply;
 }
 
+QVariant DatabaseConnection::epochMs(const QDateTime &date)
+{
+    return date.isValid() ? QVariant(date.toMSecsSinceEpoch()) : QVariant();
+}
+
 // extractMigrateUpContent parses the given migration content and retrieves only
 // the portion that applies to the "up" / apply logic. The "down" section is ignored.
-QString DatabaseConnection::extractMigrateUpContent(const QString &allContent) noexcept
+QString DatabaseConnection::extractMigrateUpContent(const QString &allContent, QString *options) noexcept
 {
     QString upContent;
     const QStringList lines = allContent.split(_newLine);
     for (const QString &line : lines) {
         auto lowerLine = line.trimmed().toLower();
-        if (lowerLine == _migrateUp)
+        if (lowerLine.startsWith(_migrateUp)) {
+            if (options)
+                *options = lowerLine.mid(_migrateUp.size()).trimmed();
             continue;
+        }
         else if (lowerLine == _migrateDown)
             break;
         upContent.append(_lineTemplate.arg(line));
@@ -377,48 +1182,72 @@ QString DatabaseConnection::extractMigrateUpContent(const QString &allContent) n
 }
 
 // executeQuery simply attempts to execute the given stmt with the passed args. The statement is
-// first prepared, and arg placements can be specified with "?"
-QSqlQuery DatabaseConnection::executeQuery(const QSqlDatabase& db, const QString &stmt,
-                                           const QVariantList &args) {
-  auto result = executeQueryNoThrow(db, stmt, args);
+// first prepared (or taken from the statement cache), and arg placements can be specified with "?"
+SharedQuery DatabaseConnection::executeQuery(const QString &stmt, const QVariantList &args, bool cache) {
+  auto result = executeQueryNoThrow(stmt, args, cache);
   if (!result.success)
     qWarning() << "Error executing Query: " << result.err.text();
   return std::move(result.query);
 }
 
-QueryResult DatabaseConnection::executeQueryNoThrow(const QSqlDatabase& db, const QString &stmt,
-                                                  const QVariantList &args) noexcept
+QueryResult DatabaseConnection::executeQueryNoThrow(const QString &stmt, const QVariantList &args,
+                                                    bool cache) noexcept
 {
-    QSqlQuery query(db);
-    if (!query.prepare(stmt))
-        return QueryResult(std::move(query));
-    for (const auto &arg : args)
-        query.addBindValue(arg);
-    query.exec();
-    return QueryResult(std::move(query));
+    // for a select, this covers the time to the first row; reading the rest is up to the caller
+    QElapsedTimer timer;
+    timer.start();
+    auto result = runStatement(stmt, args, cache);
+    _queryStats.record(stmt, timer.nsecsElapsed() / 1000, rowsTouched(*result.query));
+    return result;
+}
+
+QueryResult DatabaseConnection::runStatement(const QString &stmt, const QVariantList &args,
+                                             bool cache) noexcept
+{
+    bool prepared = true;
+    auto query = cache ? _statements->acquire(_db, stmt, &prepared) : std::make_shared<QSqlQuery>(_db);
+    if (!cache) {
+        query->setForwardOnly(true);
+        prepared = query->prepare(stmt);
+    }
+    if (prepared) {
+        // bind by position, so a reused statement replaces its previous values
+        for (int i = 0; i < args.size(); i++)
+            query->bindValue(i, args.at(i));
+        query->exec();
+    }
+    QueryResult result(std::move(query));
+    if (!result.success)
+        _statementError = result.err.text();
+    return result;
+}
+
+qint64 DatabaseConnection::rowsTouched(const QSqlQuery &query)
+{
+    return (!query.isActive() || query.isSelect()) ? -1 : query.numRowsAffected();
 }
 
 // doInsert is a version of executeQuery that returns the last inserted id, rather than the
 // underlying query/response
 // Logs then returns -1
-qint64 DatabaseConnection::doInsert(const QSqlDatabase& db, const QString &stmt, const QVariantList &args)
+qint64 DatabaseConnection::doInsert(const QString &stmt, const QVariantList &args)
 {
-  auto query = executeQuery(db, stmt, args);
-  if(query.lastInsertId() != QVariant())
-    return query.lastInsertId().toLongLong();
+  auto query = executeQuery(stmt, args);
+  if(query->lastInsertId() != QVariant())
+    return query->lastInsertId().toLongLong();
   return -1;
 }
 
-void DatabaseConnection::batchInsert(const QString& baseQuery, unsigned int varsPerRow, unsigned int numRows,
+bool DatabaseConnection::batchInsert(const QString& baseQuery, unsigned int varsPerRow, unsigned int numRows,
                                      const FieldEncoderFunc& encodeValues, QString rowInsertTemplate) {
   if (rowInsertTemplate.isEmpty()) {
     rowInsertTemplate = "(" + QString("?,").repeated(varsPerRow > 0 ? varsPerRow-1 : 0) + "?),";
   }
   auto noop = [](const QSqlQuery&){};
-  batchQuery(baseQuery, varsPerRow, numRows, encodeValues, noop, rowInsertTemplate);
+  return batchQuery(baseQuery, varsPerRow, numRows, encodeValues, noop, rowInsertTemplate);
 }
 
-void DatabaseConnection::batchQuery(const QString &baseQuery, unsigned int varsPerRow,
+bool DatabaseConnection::batchQuery(const QString &baseQuery, unsigned int varsPerRow,
                                     unsigned int numRows, const FieldEncoderFunc &encodeValues,
                                     const RowDecoderFunc& decodeRows, QString variableTemplate) {
   unsigned long frameSize = SQLITE_MAX_VARS / varsPerRow;
@@ -446,11 +1275,25 @@ void DatabaseConnection::batchQuery(const QString &baseQuery, unsigned int varsP
     return values;
   };
   /// runQuery executes the given query, and iterates over the result set
-  auto runQuery = [this, decodeRows](const QString &query, const QVariantList& values) {
-    auto completedQuery = executeQuery(_db, query, values);
-    while (completedQuery.next()) {
-      decodeRows(completedQuery);
+  bool allSucceeded = true;
+  auto runQuery = [this, decodeRows, &allSucceeded](const QString &query, const QVariantList& values) {
+    // each batch is timed through to its last row, so the stats include reading the result set
+    QElapsedTimer timer;
+    timer.start();
+    // batches are large and rarely repeat exactly, so they bypass the statement cache
+    auto result = runStatement(query, values, false);
+    auto &completedQuery = result.query;
+    if (!result.success) {
+      qWarning() << "Error executing Query: " << result.err.text();
+      allSucceeded = false;
+    }
+    qint64 rowsRead = 0;
+    while (completedQuery->next()) {
+      decodeRows(*completedQuery);
+      rowsRead++;
     }
+    auto rows = completedQuery->isSelect() ? rowsRead : rowsTouched(*completedQuery);
+    _queryStats.record(query, timer.nsecsElapsed() / 1000, rows);
   };
 
   // do full frames
@@ -466,4 +1309,5 @@ void DatabaseConnection::batchQuery(const QString &baseQuery, unsigned int varsP
     QVariantList overflowValues = encodeRowValues(overflow);
     runQuery(overflowQuery, overflowValues);
   }
+  return allSucceeded;
 }
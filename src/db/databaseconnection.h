@@ -12,7 +12,13 @@
 #include "forms/evidence_filter/evidencefilter.h"
 #include "models/evidence.h"
 #include "helpers/constants.h"
+#include "databasetransaction.h"
+#include "evidencecursor.h"
+#include "migrationmanifest.h"
 #include "query_result.h"
+#include "querystats.h"
+#include "rowdecoders.h"
+#include "statementcache.h"
 
 using FieldEncoderFunc = std::function<QVariantList(unsigned int)>;
 using RowDecoderFunc = std::function<void(const QSqlQuery&)>;
@@ -28,12 +34,50 @@ class DBQuery {
   inline QString query() { return _query; }
   inline QVariantList values() { return _values; }
 };
+/**
+ * @brief The SqlitePragmas struct holds the tuning pragmas applied to each connection as it is
+ * opened. The defaults favor many small writes (captures) without blocking readers.
+ */
+struct SqlitePragmas {
+  /// journal_mode: one of DELETE, TRUNCATE, PERSIST, MEMORY, WAL, OFF
+  QString journalMode = QStringLiteral("WAL");
+  /// synchronous: one of OFF, NORMAL, FULL, EXTRA. NORMAL is durable when paired with WAL
+  QString synchronous = QStringLiteral("NORMAL");
+  /// mmap_size in bytes. 0 disables memory mapped I/O
+  qint64 mmapSize = 268435456;
+  /// cache_size: positive values are pages, negative values are KiB
+  qint64 cacheSize = -16000;
+  /// temp_store: one of DEFAULT, FILE, MEMORY
+  QString tempStore = QStringLiteral("MEMORY");
+  /// busy_timeout in milliseconds
+  qint64 busyTimeout = 5000;
+};
+
+/// QueuedUpload is evidence waiting in the upload queue, along with its failed attempts so far
+struct QueuedUpload {
+  model::Evidence evidence;
+  int attempts = 0;
+};
+
+/// PendingTag is a tag created while the server was unreachable, waiting in the tag outbox. Until
+/// it exists on the server, it is known locally by a placeholder (negative) server tag id.
+struct PendingTag {
+  qint64 id = 0;
+  QString operationSlug;
+  QString name;
+  QString colorName;
+  qint64 placeholderID() const { return -id; }
+  static bool isPlaceholder(qint64 serverTagID) { return serverTagID < 0; }
+};
+
 /**
  * @brief The DatabaseConnection class Interface to the local database
  * All Changes / reads to db should return true on success
  * any failed actions can have erorrs checked with DatabaseConnection::errorString()
  */
 class DatabaseConnection {
+  friend class DatabaseTransaction;
+
  public:
   const unsigned long SQLITE_MAX_VARS = 999;
   QString getDatabasePath() { return _dbPath; }
@@ -58,16 +102,75 @@ class DatabaseConnection {
    */
   static bool withConnection(const QString& dbPath, const QString &dbName,
                              const std::function<void(DatabaseConnection)> &actions);
+  /// withReadOnlyConnection is withConnection for a connection that only reads (see connectReadOnly).
+  /// The database must already exist, and be migrated.
+  static bool withReadOnlyConnection(const QString& dbPath, const QString &dbName,
+                                     const std::function<void(DatabaseConnection)> &actions);
 
-  ///Return the last Error
-  QString errorString() {return _db.lastError().text();}
-  bool connect();
-  void close() noexcept {_db.close();}
+  /// errorString returns the error of the most recent failed statement since clearError, or
+  /// failing that, the connection's own error (e.g. from opening the database)
+  QString errorString() {return _statementError.isEmpty() ? _db.lastError().text() : _statementError;}
+  /// clearError forgets any earlier statement error, e.g. before starting an unrelated action
+  void clearError() { _statementError.clear(); }
+  /**
+   * @brief MigrationProgressCallback is called as each pending migration is applied, with the
+   * migration's name and how far through it is (0 to 100). Data migrations report as each batch
+   * completes; all others report only when starting and finishing.
+   */
+  using MigrationProgressCallback = std::function<void(const QString &migrationName, int percentDone)>;
+  /// connect opens the database, then applies any pending migrations, reporting to onMigrationProgress
+  bool connect(const MigrationProgressCallback &onMigrationProgress = {});
+  /**
+   * @brief connectReadOnly opens the database for reading only: pragmas are applied, but nothing is
+   * migrated. Used for reader connections alongside the (single) writer, which must have connected
+   * (and migrated) first. Concurrent reads rely on WAL, which keeps a reader's view of the database
+   * fixed for the length of each read, without blocking the writer.
+   */
+  bool connectReadOnly();
+  /// close releases any cached statements, then closes the database
+  void close() noexcept;
+  bool isOpen() const { return _db.isOpen(); }
+  /// journalMode returns the journal mode in effect (lower case), as read back once the pragmas
+  /// were applied. This may differ from the requested mode (e.g. WAL is refused on some filesystems).
+  QString journalMode() const { return _journalMode; }
 
-  static DBQuery buildGetEvidenceWithFiltersQuery(const EvidenceFilters &filters);
+  /// setPragmaProfile sets the pragmas applied to every connection opened after this call.
+  /// Should be set once, before any connection is opened.
+  static void setPragmaProfile(const SqlitePragmas& pragmas) { _pragmas = pragmas; }
+  static SqlitePragmas pragmaProfile() { return _pragmas; }
+
+  /// queryStats holds the timing of every statement run, over all connections. Statements slower
+  /// than its slow query threshold are logged.
+  static QueryStats& queryStats() { return _queryStats; }
+
+  /**
+   * @brief buildGetEvidenceWithFiltersQuery builds the query for evidence matching filters, ordered
+   * by (recorded_ms, id)
+   * @param after if valid, only rows ordered after this key are matched
+   * @param limit the maximum number of rows to return, or -1 for no limit
+   */
+  static DBQuery buildGetEvidenceWithFiltersQuery(const EvidenceFilters &filters,
+                                                  const EvidencePageKey &after = EvidencePageKey(),
+                                                  int limit = -1);
 
   model::Evidence getEvidenceDetails(qint64 evidenceID);
+  /**
+   * @brief getEvidenceDetails retrieves many evidence items, with their tags, in a fixed number of
+   * (batched) queries rather than two queries per item.
+   * @param evidenceIDs the evidence to retrieve
+   * @return A list with one entry per requested id, in the requested order. Ids that could not be
+   * found have an id of -1.
+   */
+  QList<model::Evidence> getEvidenceDetails(const QList<qint64>& evidenceIDs);
   QList<model::Evidence> getEvidenceWithFilters(const EvidenceFilters &filters);
+  /// getEvidenceIDsWithFilters returns the id of every evidence matching filters, without loading the rest of each row
+  QList<qint64> getEvidenceIDsWithFilters(const EvidenceFilters &filters);
+  /**
+   * @brief getEvidencePage retrieves up to pageSize evidence matching filters, starting after the
+   * given key. Tags are not populated. See also EvidenceCursor.
+   */
+  EvidencePage getEvidencePage(const EvidenceFilters &filters, const EvidencePageKey &after,
+                               int pageSize);
 
   /// Return -1 if Failed
   qint64 createEvidence(const QString &filepath, const QString &operationSlug,
@@ -83,19 +186,149 @@ class DatabaseConnection {
   * @return True if successful
   */
   bool updateEvidenceDescription(const QString &newDescription, qint64 evidenceID);
+
+  /**
+   * @brief updateSearchIndex (re)indexes the description, and codeblock content if applicable, of
+   * the given evidence for full text search
+   * @return true if successful
+   */
+  bool updateSearchIndex(qint64 evidenceID);
+  /// indexPendingCodeblocks indexes the content of any codeblock evidence that has not yet had its
+  /// content indexed (e.g. evidence recorded before the search index existed)
+  void indexPendingCodeblocks();
+  /// toSearchQuery converts user entered text into an FTS5 query that matches every word (or word
+  /// prefix), with no special syntax
+  static QString toSearchQuery(const QString &text);
   bool updateEvidenceError(const QString &errorText, qint64 evidenceID);
   void updateEvidenceSubmitted(qint64 evidenceID);
   void updateEvidencePath(const QString& newPath, qint64 evidenceID);
+  /**
+   * @brief setEvidenceTags replaces the tags on the given evidence with newTags (an empty list
+   * removes every tag). Only the difference is written: one batched delete for the removed tags
+   * and one batched insert for the added ones, in a single transaction. Placeholders for pending
+   * tags that have since been created are replaced with the server tag.
+   * @return true if successful
+   */
   bool setEvidenceTags(const QList<model::Tag> &newTags, qint64 evidenceID);
+  /// batchCopyTags copies tags into an export database. Pending tags are not copied.
   void batchCopyTags(const QList<model::Tag> &allTags);
   QList<model::Tag> getFullTagsForEvidenceIDs(const QList<qint64>& evidenceIDs);
 
   /**
-   * @brief deleteEvidence Delete Evidence from the database
+   * @brief deleteEvidence marks Evidence as deleted. Deleted evidence is hidden from every
+   * filtered query; the record, tags and file are later removed by the EvidenceCollector.
    * @param evidenceID - ID To Delete
    * @return true if successful
    */
   bool deleteEvidence(qint64 evidenceID);
+  /**
+   * @brief deleteEvidence marks many evidence as deleted, in a single transaction. Either every
+   * record is marked, or none are.
+   * @param evidenceIDs the evidence to delete
+   * @return true if successful
+   */
+  bool deleteEvidence(const QList<qint64>& evidenceIDs);
+  /**
+   * @brief getDeletedEvidence retrieves evidence that has been marked as deleted, oldest deletions first
+   * @param deletedBefore only evidence deleted at or before this time (epoch milliseconds) is returned
+   * @param limit the maximum number of evidence to return
+   */
+  QList<model::Evidence> getDeletedEvidence(qint64 deletedBefore, int limit);
+  /**
+   * @brief purgeEvidence permanently removes deleted evidence, and its tags, from the database, in a
+   * single transaction. Files are not touched.
+   * @return true if successful
+   */
+  bool purgeEvidence(const QList<qint64>& evidenceIDs);
+  /// deferPurge moves already deleted evidence to the back of the purge queue, e.g. when its
+  /// file could not be removed yet
+  bool deferPurge(const QList<qint64>& evidenceIDs);
+
+  // Upload queue. Queued uploads are kept until they succeed or fail for good, so they survive a
+  // restart; see UploadQueue.
+
+  /**
+   * @brief enqueueUploads adds the given evidence to the upload queue, due immediately, and clears
+   * any previous upload error. Evidence that is already queued is made due now, with its attempts
+   * reset. Evidence that has already been submitted (or deleted) is skipped.
+   * @param queuedIDs (if provided) receives the evidence that was queued
+   * @return true if successful
+   */
+  bool enqueueUploads(const QList<qint64>& evidenceIDs, QList<qint64>* queuedIDs = nullptr);
+  /// getQueuedUploads returns the failed attempts so far for each queued evidence
+  QHash<qint64, int> getQueuedUploads();
+  /**
+   * @brief getDueUploads retrieves (with tags) up to limit queued evidence that is due at nowMs,
+   * most overdue first. Deleted evidence, and evidence waiting on a pending tag, is skipped.
+   * @param excludeIDs evidence to leave out (i.e. uploads already in flight)
+   */
+  QList<QueuedUpload> getDueUploads(qint64 nowMs, int limit, const QList<qint64>& excludeIDs);
+  /// nextUploadAttemptMs returns when the next queued upload (not in excludeIDs) is due, in epoch
+  /// milliseconds, or -1 if nothing else is queued (evidence waiting on a pending tag is not counted)
+  qint64 nextUploadAttemptMs(const QList<qint64>& excludeIDs);
+  /// hasUploadsWaitingOnTags returns true if any queued evidence is tagged with a pending tag
+  bool hasUploadsWaitingOnTags();
+  /// completeUpload removes the evidence from the upload queue and marks it submitted, in a single transaction
+  bool completeUpload(qint64 evidenceID);
+  /// retryUpload records a failed attempt on queued evidence, and schedules the next one for nextAttemptMs
+  bool retryUpload(qint64 evidenceID, qint64 nextAttemptMs, const QString& error);
+  /// failUpload removes the evidence from the upload queue, and records error on the evidence, in a
+  /// single transaction
+  bool failUpload(qint64 evidenceID, const QString& error);
+  /// deferUpload records an attempt that could not reach the server. No attempt is counted, and the
+  /// upload is due again straight away (the UploadQueue holds off until the server is back)
+  bool deferUpload(qint64 evidenceID, const QString& error);
+  /// resetUploadBackoff makes every queued upload due now, e.g. once the server is reachable again
+  bool resetUploadBackoff();
+
+  // Tag outbox. Tags created while the server is unreachable are kept here until they can be
+  // created on the server. Evidence using them is not uploaded until then.
+
+  /**
+   * @brief queueTagCreation adds a tag to the tag outbox (unless the same name is already pending
+   * for the operation), and to the tag dictionary under its placeholder id, so that it can be used
+   * straight away.
+   * @param pending receives the queued (or already pending) tag
+   * @return true if successful
+   */
+  bool queueTagCreation(const QString& operationSlug, const QString& name, const QString& colorName,
+                        PendingTag* pending);
+  /// getPendingTags returns the tags waiting to be created, oldest first. When operationSlug is
+  /// empty, the tags for every operation are returned.
+  QList<PendingTag> getPendingTags(const QString& operationSlug = QString());
+  /**
+   * @brief resolvePendingTag records the server tag created for (or found matching) a pending tag.
+   * Evidence tagged with the placeholder is moved over to the server tag, in a single transaction.
+   * @return true if successful
+   */
+  bool resolvePendingTag(qint64 pendingID, qint64 serverTagID, const QString& name, const QString& colorName);
+  /// abandonPendingTag gives up on a tag that the server refused to create. The tag is removed from
+  /// any evidence, which is then uploaded without it.
+  bool abandonPendingTag(qint64 pendingID, const QString& error);
+
+  // Maintenance. Each call does a small, bounded amount of work, so that DatabaseMaintenance can
+  // spread it over idle time.
+
+  /// optimize lets sqlite refresh any out of date query planner statistics (PRAGMA optimize).
+  /// Analysis is limited to a sample of each index, so this stays quick on large databases.
+  bool optimize();
+  /// freeBytes returns the space held by free pages, which incrementalVacuum can return to the
+  /// file system. Returns -1 on error.
+  qint64 freeBytes();
+  /**
+   * @brief incrementalVacuum returns up to maxPages free pages to the file system. Only databases
+   * created with auto_vacuum=INCREMENTAL (see connect) can do so; for others, nothing is reclaimed.
+   * @return the number of bytes reclaimed, or -1 on error
+   */
+  qint64 incrementalVacuum(int maxPages);
+  /// listTables returns the name of every table in the database, e.g. to quickCheck in turn
+  QStringList listTables();
+  /**
+   * @brief quickCheck runs sqlite's quick_check over a single table, and its indexes.
+   * @param problems receives each problem found; empty when the table is healthy
+   * @return true if the check ran
+   */
+  bool quickCheck(const QString& table, QStringList* problems);
 
   /// createEvidenceExportView duplicates the normal database with only a subset of evidence
   /// present, as well as related data (e.g. tags)
@@ -109,11 +342,30 @@ class DatabaseConnection {
 
   QSqlError lastError() {return _db.lastError();}
 
+  /// statementCacheStats returns the hit/miss/eviction counts for this connection's prepared
+  /// statement cache
+  StatementCache::Stats statementCacheStats() const { return _statements->stats(); }
+
  private:
   QString _dbName;
   QString _dbPath;
+  /// _statementError is the error text of the most recent failed statement (see errorString)
+  QString _statementError;
+  /// _journalMode is the effective journal mode (see journalMode)
+  QString _journalMode;
   QSqlDatabase _db = QSqlDatabase();
+  /// _statements is shared between copies of this connection, just like the underlying _db is
+  std::shared_ptr<StatementCache> _statements = std::make_shared<StatementCache>();
+  /// _transactionDepth is the number of open DatabaseTransactions; shared between copies, like _db
+  std::shared_ptr<int> _transactionDepth = std::make_shared<int>(0);
+  inline static SqlitePragmas _pragmas;
+  inline static QueryStats _queryStats;
   inline static const auto _migrateUp = QStringLiteral("-- +migrate up");
+  /// _migrationOptionBatch marks a data migration, followed by the table it runs over
+  inline static const auto _migrationOptionBatch = QStringLiteral("batch ");
+  /// _autoVacuumIncremental is the value PRAGMA auto_vacuum reports for auto_vacuum=INCREMENTAL
+  inline static const int _autoVacuumIncremental = 2;
+  inline static const int _maintenanceAnalysisLimit = 400;
   inline static const auto _migrateDown = QStringLiteral("-- +migrate down");
   inline static const auto _newLine = QStringLiteral("\n");
   inline static const auto _lineTemplate = QStringLiteral("%1").append(_newLine);
@@ -121,41 +373,106 @@ class DatabaseConnection {
   inline static const auto _sqlSelectTemplate = QStringLiteral("SELECT %1 FROM %2");
   inline static const auto _sqlBasicInsert = QStringLiteral("INSERT INTO %1 (%2) VALUES (%3)");
   inline static const auto _sqlAddAppliedMigration = QStringLiteral("INSERT INTO migrations (migration_name, applied_at) VALUES (?, datetime('now'))");
-  inline static const auto _migration_name = QStringLiteral("migration_name");
+  inline static const auto _sqlAddMigrationInProgress = QStringLiteral("INSERT INTO migrations (migration_name, progress) VALUES (?, 0)");
+  inline static const auto _sqlSelectMigrationProgress = QStringLiteral("SELECT progress FROM migrations WHERE migration_name = ? AND applied_at IS NULL");
+  inline static const auto _sqlUpdateMigrationProgress = QStringLiteral("UPDATE migrations SET progress = ? WHERE migration_name = ?");
+  inline static const auto _sqlCompleteMigration = QStringLiteral("UPDATE migrations SET applied_at = datetime('now') WHERE migration_name = ?");
+  inline static const auto _sqlSelectAppliedMigrations = QStringLiteral("SELECT migration_name FROM migrations WHERE applied_at IS NOT NULL");
+  inline static const auto _sqlSelectUserVersion = QStringLiteral("PRAGMA user_version");
+  inline static const auto _sqlSetUserVersion = QStringLiteral("PRAGMA user_version = %1");
   inline static const auto _tblEvidence = QStringLiteral("evidence");
-  inline static const auto _tblMigrations = QStringLiteral("migrations");
-  inline static const auto _evidenceAllKeys = QStringLiteral("id, path, operation_slug, content_type, description, error, recorded_date, upload_date");
+  /// _sqlSelectEvidenceTags selects evidence tags, shaped as TagRowDecoder expects, aliased "et"
+  inline static const auto _sqlSelectEvidenceTags = QStringLiteral(
+      "SELECT et.id, et.evidence_id, d.server_tag_id AS tag_id, d.name, d.color"
+      " FROM evidence_tags AS et JOIN tag_dictionary AS d ON d.id = et.tag_id");
+  inline static const auto _evidenceAllKeys = QStringLiteral("id, path, operation_slug, content_type, description, error, recorded_date, upload_date, recorded_ms, upload_ms");
+  inline static const int _dataMigrationBatchSize = 1000;
+  /// _sqlQueuedUploadCondition matches queued uploads ("q") for evidence ("e") that is still present
+  inline static const auto _sqlQueuedUploadCondition = QStringLiteral(
+      "FROM upload_queue AS q JOIN evidence AS e ON e.id = q.evidence_id WHERE e.deleted_at IS NULL");
+  /// _sqlUploadWaitingOnTags matches queued uploads ("q") tagged with a pending (placeholder) tag
+  inline static const auto _sqlUploadWaitingOnTags = QStringLiteral(
+      "EXISTS (SELECT 1 FROM evidence_tags AS et JOIN tag_dictionary AS d ON d.id = et.tag_id"
+      " WHERE et.evidence_id = q.evidence_id AND d.server_tag_id < 0)");
 
   /**
-   * @brief migrateDB - Check migration status and apply any outstanding ones
+   * @brief applyPragmas applies the pragma profile to the open connection, then logs the values
+   * sqlite actually settled on (e.g. WAL is refused on some network filesystems).
+   * Invalid profile values are logged and replaced with their defaults.
+   * @param readOnly true to skip the pragmas that write to the database (i.e. journal_mode)
+   */
+  void applyPragmas(bool readOnly);
+  static bool withConnection(const QString& dbPath, const QString &dbName,
+                             const std::function<void(DatabaseConnection)> &actions, bool readOnly);
+
+  /**
+   * @brief migrateDB - Check migration status and apply any outstanding ones. A database whose
+   * user_version matches the migration manifest is current, and is not checked further. Otherwise,
+   * each pending migration's content is checked against the manifest, then the schema migrations
+   * between data migrations are each applied in a single transaction.
    * @return true if successful
    */
-  bool migrateDB();
+  bool migrateDB(const MigrationProgressCallback &onProgress);
+  /**
+   * @brief applyDataMigration runs a data migration (marked "-- +migrate Up batch <table>") over
+   * table, in batches of _dataMigrationBatchSize rows, ordered by id. statement receives the
+   * (exclusive) lower and (inclusive) upper id of each batch. Progress is recorded in the
+   * migrations table alongside each batch, so an interrupted migration resumes where it stopped.
+   * @return true if successful
+   */
+  bool applyDataMigration(const QString &migrationName, const QString &statement, const QString &table,
+                          const MigrationProgressCallback &onProgress);
 
   /**
-   * @brief getUnappliedMigrations retrieves a list of all of the migrations that have not been applied to the database db
-   * Note: only files ending in ".sql" are checked
+   * @brief getUnappliedMigrations retrieves the manifest entries for each migration that has not
+   * been applied to the database, in the order they should be applied
    * @return List of migrations that have not be applied
    */
-  QStringList getUnappliedMigrations();
-  QString extractMigrateUpContent(const QString &allContent) noexcept;
-  static QSqlQuery executeQuery(const QSqlDatabase& db, const QString &stmt,
-                                const QVariantList &args = {});
+  QList<const MigrationManifestEntry*> getUnappliedMigrations();
+  /// extractMigrateUpContent returns the "up" statement of a migration. options (if provided)
+  /// receives anything following "-- +migrate Up" (e.g. "batch evidence")
+  QString extractMigrateUpContent(const QString &allContent, QString *options = nullptr) noexcept;
+
+  /// markDeleted sets deleted_at to the current time for each of the given evidence that also
+  /// satisfy condition. Either every record is updated, or none are.
+  bool markDeleted(const QList<qint64>& evidenceIDs, const QString& condition);
+  /// excludeIDsCondition returns " AND <column> NOT IN (...)" for the given ids (or nothing, when
+  /// there are none). The ids are integers, so they are safe to inline, leaving every variable free.
+  static QString excludeIDsCondition(const QString& column, const QList<qint64>& ids);
+  /// upsertTagDictionary adds any unknown tags to the tag dictionary, and refreshes the name (and
+  /// color, if known) of the rest
+  bool upsertTagDictionary(const QList<model::Tag>& tags);
+  /// remapPlaceholderTags replaces placeholder ids with the server tag, for pending tags that have
+  /// since been created, and drops tags that were abandoned. Editors (and the last used tags) can
+  /// hold on to a placeholder long after the tag was created.
+  bool remapPlaceholderTags(QList<model::Tag>* tags);
+  /// dropDictionaryTag removes the tag (by server tag id) from the tag dictionary, and from any evidence
+  bool dropDictionaryTag(qint64 serverTagID);
+  /// epochMs converts a date to the value stored in the *_ms columns (NULL for invalid dates)
+  static QVariant epochMs(const QDateTime &date);
+  /// executeQuery runs stmt with the given args, logging any error. Set cache to false for
+  /// statements that are unlikely to be run again (e.g. migrations), so they do not push frequently
+  /// used statements out of the statement cache.
+  SharedQuery executeQuery(const QString &stmt, const QVariantList &args = {}, bool cache = true);
 
   /// executeQueryNoThrow provides a safe mechanism to execute a query on the database. (Safe in the
   /// sense that no exception is thrown). It is incumbent on the caller to inspect the
   /// QueryResult.sucess/QueryResult.err fields to determine the actual result.
-  static QueryResult executeQueryNoThrow(const QSqlDatabase& db, const QString &stmt,
-                                const QVariantList &args = {}) noexcept;
+  QueryResult executeQueryNoThrow(const QString &stmt, const QVariantList &args = {},
+                                  bool cache = true) noexcept;
+  /// runStatement prepares (or reuses) and executes stmt, without recording any timing
+  QueryResult runStatement(const QString &stmt, const QVariantList &args, bool cache) noexcept;
+  /// rowsTouched returns the rows written by a completed query, or -1 for a select (as its rows are
+  /// only known once read)
+  static qint64 rowsTouched(const QSqlQuery &query);
 
   /**
    * @brief doInsert is a version of executeQuery that returns the last inserted id, rather than the underlying query/response
-   * @param db database to act upon
    * @param stmt sql to run
    * @param args args
    * @return Inserted ID or -1 if failed.
    */
-  static qint64 doInsert(const QSqlDatabase &db, const QString &stmt, const QVariantList &args);
+  qint64 doInsert(const QString &stmt, const QVariantList &args);
 
   /**
    * @brief batchInsert batches multiple inserts over as few requests as possible.
@@ -164,8 +481,9 @@ class DatabaseConnection {
    * @param numRows the number of rows you wish to insert
    * @param encodeValues A function that, given a row index, will return a QVariantList with each column's data for that row
    * @param rowInsertTemplate An optional string that can be used to define each row's values. Defaults to (?, ..., ?)
+   * @return true if every batch succeeded
    */
-  void batchInsert(const QString& baseQuery, unsigned int varsPerRow, unsigned int numRows,
+  bool batchInsert(const QString& baseQuery, unsigned int varsPerRow, unsigned int numRows,
                    const FieldEncoderFunc& encodeValues, QString rowInsertTemplate = QString());
 
   /**
@@ -177,8 +495,9 @@ class DatabaseConnection {
    * @param encodeValues A function that, given an index, returns a QVariantList for each variable group
    * @param decodeRows A function that can be used to retrieve the rows from the result set
    * @param variableTemplate An optional string that can be used to define how variables are handled. Defaults to ?,...,?
+   * @return true if every batch succeeded
    */
-  void batchQuery(const QString &baseQuery, unsigned int varsPerRow, unsigned int numRows,
+  bool batchQuery(const QString &baseQuery, unsigned int varsPerRow, unsigned int numRows,
                   const FieldEncoderFunc &encodeValues, const RowDecoderFunc& decodeRows,
                   QString variableTemplate = QString());
 };
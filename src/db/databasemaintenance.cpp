@@ -0,0 +1,154 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#include "databasemaintenance.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+#include "databaseworker.h"
+
+DatabaseMaintenance::DatabaseMaintenance(DatabaseWorker* db, QObject* parent)
+  : QObject(parent)
+  , db(db)
+{
+  idleTimer.setSingleShot(true);
+  stepTimer.setSingleShot(true);
+  stepTimer.setInterval(stepDelayMs);
+  connect(&idleTimer, &QTimer::timeout, this, [this] {
+    if (running)
+      runStep();
+    else
+      startPass();
+  });
+  connect(&stepTimer, &QTimer::timeout, this, &DatabaseMaintenance::runStep);
+  connect(db, &DatabaseWorker::evidenceDeleted, this, &DatabaseMaintenance::postpone);
+  idleTimer.start(idleDelayMs);
+}
+
+void DatabaseMaintenance::postpone()
+{
+  stepTimer.stop();
+  // a pass that is underway (or about to start) waits for the application to be idle again;
+  // a pass that is hours away keeps its schedule
+  if (running || idleTimer.remainingTime() < idleDelayMs)
+    idleTimer.start(idleDelayMs);
+}
+
+void DatabaseMaintenance::startPass()
+{
+  running = true;
+  stage = Stage::Optimize;
+  reclaimedBytes = 0;
+  durationMs = 0;
+  healthy = true;
+  runStep();
+}
+
+void DatabaseMaintenance::runStep()
+{
+  if (stepInFlight)
+    return; // the step in flight picks the next one when it finishes
+  stepInFlight = true;
+  auto currentStage = stage;
+  auto table = stage == Stage::QuickCheck ? tablesToCheck.first() : QString();
+  db->run([currentStage, table](DatabaseConnection* conn) {
+    conn->clearError();
+    StepResult result;
+    QElapsedTimer timer;
+    timer.start();
+    switch (currentStage) {
+      case Stage::Optimize:
+        result.success = conn->optimize();
+        break;
+      case Stage::Vacuum:
+        result.reclaimedBytes = conn->incrementalVacuum(vacuumStepPages);
+        result.success = result.reclaimedBytes >= 0;
+        break;
+      case Stage::ListTables:
+        result.tables = conn->listTables();
+        result.success = !result.tables.isEmpty();
+        break;
+      case Stage::QuickCheck:
+        result.success = conn->quickCheck(table, &result.problems);
+        break;
+      case Stage::Done:
+        result.success = true;
+        break;
+    }
+    result.elapsedMs = timer.elapsed();
+    if (!result.success)
+      result.errorText = conn->errorString();
+    return result;
+  }).then(this, [this](const StepResult& result) {
+    onStepFinished(result);
+  });
+}
+
+void DatabaseMaintenance::onStepFinished(const StepResult& result)
+{
+  stepInFlight = false;
+  durationMs += result.elapsedMs;
+  if (!result.success)
+    qWarning() << "Database maintenance step failed. Error:" << result.errorText;
+
+  switch (stage) {
+    case Stage::Optimize:
+      stage = Stage::Vacuum;
+      break;
+    case Stage::Vacuum:
+      reclaimedBytes += std::max<qint64>(0, result.reclaimedBytes);
+      // keep vacuuming while pages are still being freed
+      if (result.reclaimedBytes <= 0) {
+        if (!quickCheckDue())
+          stage = Stage::Done;
+        else
+          stage = tablesToCheck.isEmpty() ? Stage::ListTables : Stage::QuickCheck;
+      }
+      break;
+    case Stage::ListTables:
+      tablesToCheck = result.tables;
+      stage = tablesToCheck.isEmpty() ? Stage::Done : Stage::QuickCheck;
+      break;
+    case Stage::QuickCheck: {
+      auto table = tablesToCheck.takeFirst();
+      if (!result.problems.isEmpty()) {
+        healthy = false;
+        qWarning() << "Database quick_check found problems in" << table << ":" << result.problems;
+      }
+      if (tablesToCheck.isEmpty()) {
+        lastQuickCheck = QDateTime::currentMSecsSinceEpoch();
+        stage = Stage::Done;
+      }
+      break;
+    }
+    case Stage::Done:
+      break;
+  }
+
+  if (stage == Stage::Done || durationMs >= passBudgetMs) {
+    finishPass();
+    return;
+  }
+  // when postponed, the idle timer resumes the pass instead
+  if (!idleTimer.isActive())
+    stepTimer.start();
+}
+
+void DatabaseMaintenance::finishPass()
+{
+  running = false;
+  stage = Stage::Done;
+  qInfo() << "Database maintenance reclaimed" << reclaimedBytes << "bytes in" << durationMs << "ms";
+  Q_EMIT maintenanceFinished(reclaimedBytes, durationMs, healthy);
+  idleTimer.start(passIntervalMs);
+}
+
+bool DatabaseMaintenance::quickCheckDue() const
+{
+  // a check cut short by the pass budget carries on regardless of the interval
+  return !tablesToCheck.isEmpty() || lastQuickCheck == 0
+         || QDateTime::currentMSecsSinceEpoch() - lastQuickCheck >= quickCheckIntervalMs;
+}
@@ -0,0 +1,78 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+class DatabaseWorker;
+
+/**
+ * @brief The DatabaseMaintenance class keeps the evidence database healthy during idle time.
+ * Once the application has been quiet for a while, a maintenance pass refreshes the query planner
+ * statistics (DatabaseConnection::optimize), returns free pages left behind by deletes to the file
+ * system (incrementalVacuum), and, periodically, runs quick_check over each table in turn.
+ * Work is done in small steps with a pause between each, so captures never wait long behind it.
+ * Any activity (see postpone) pauses the pass until the application is quiet again.
+ */
+class DatabaseMaintenance : public QObject {
+  Q_OBJECT
+
+ public:
+  /// DatabaseMaintenance schedules the first pass once db has been idle for idleDelayMs.
+  /// db must outlive the maintenance (e.g. make db the parent).
+  DatabaseMaintenance(DatabaseWorker* db, QObject* parent = nullptr);
+
+  /// postpone holds off any maintenance until the application has been idle for idleDelayMs.
+  /// Call when starting work that maintenance should stay out of the way of (e.g. a capture).
+  void postpone();
+
+ Q_SIGNALS:
+  /// maintenanceFinished is emitted when a pass completes, with the space returned to the file
+  /// system, the time spent on the database thread, and whether every table checked was healthy
+  void maintenanceFinished(qint64 reclaimedBytes, qint64 durationMs, bool healthy);
+
+ private:
+  enum class Stage { Optimize, Vacuum, ListTables, QuickCheck, Done };
+
+  /// StepResult is produced by each step on the database thread
+  struct StepResult {
+    bool success = false;
+    qint64 reclaimedBytes = 0;
+    qint64 elapsedMs = 0;
+    QStringList tables;
+    QStringList problems;
+    QString errorText;
+  };
+
+  void startPass();
+  void runStep();
+  /// onStepFinished records the step's result, then picks (and schedules) the next step
+  void onStepFinished(const StepResult& result);
+  void finishPass();
+  bool quickCheckDue() const;
+
+  inline static const int idleDelayMs = 120000;
+  inline static const int stepDelayMs = 500;
+  inline static const int passIntervalMs = 6 * 60 * 60 * 1000;
+  inline static const qint64 quickCheckIntervalMs = 24 * 60 * 60 * 1000;
+  /// passBudgetMs bounds the database time spent per pass; any remaining work waits for the next pass
+  inline static const qint64 passBudgetMs = 10000;
+  inline static const int vacuumStepPages = 256;
+
+  DatabaseWorker* db = nullptr;
+  QTimer idleTimer;
+  QTimer stepTimer;
+  bool running = false;
+  /// stepInFlight is true while a step is queued on, or running on, the database thread
+  bool stepInFlight = false;
+  Stage stage = Stage::Done;
+  /// tablesToCheck remain to be quick checked; carried between passes when a pass runs out of time
+  QStringList tablesToCheck;
+  qint64 lastQuickCheck = 0;
+  qint64 reclaimedBytes = 0;
+  qint64 durationMs = 0;
+  bool healthy = true;
+};
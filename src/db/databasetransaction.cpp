@@ -0,0 +1,72 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#include "databasetransaction.h"
+
+#include "databaseconnection.h"
+
+namespace {
+QString savepointName(int level) { return QStringLiteral("ashirt_sp_%1").arg(level); }
+}
+
+DatabaseTransaction::DatabaseTransaction(DatabaseConnection* db)
+  : _db(db)
+  , _level(*db->_transactionDepth)
+{
+  // IMMEDIATE takes the write lock up front, rather than failing to upgrade a read lock later
+  auto stmt = _level == 0
+      ? QStringLiteral("BEGIN IMMEDIATE")
+      : QStringLiteral("SAVEPOINT %1").arg(savepointName(_level));
+  auto result = _db->executeQueryNoThrow(stmt);
+  if (!result.success) {
+    qWarning() << "Unable to start transaction: " << result.err.text();
+    return;
+  }
+  _active = true;
+  (*_db->_transactionDepth)++;
+}
+
+DatabaseTransaction::~DatabaseTransaction()
+{
+  if (_active)
+    rollback();
+}
+
+bool DatabaseTransaction::commit()
+{
+  if (!_active)
+    return false;
+  auto stmt = _level == 0
+      ? QStringLiteral("COMMIT")
+      : QStringLiteral("RELEASE SAVEPOINT %1").arg(savepointName(_level));
+  auto result = _db->executeQueryNoThrow(stmt);
+  if (!result.success) {
+    qWarning() << "Unable to commit transaction: " << result.err.text();
+    rollback();
+    return false;
+  }
+  _active = false;
+  (*_db->_transactionDepth)--;
+  return true;
+}
+
+void DatabaseTransaction::rollback()
+{
+  if (!_active)
+    return;
+  if (_level == 0) {
+    auto result = _db->executeQueryNoThrow(QStringLiteral("ROLLBACK"));
+    if (!result.success)
+      qWarning() << "Unable to roll back transaction: " << result.err.text();
+  }
+  else {
+    // rolling back to a savepoint leaves it on the stack, so it still needs to be released
+    auto name = savepointName(_level);
+    auto result = _db->executeQueryNoThrow(QStringLiteral("ROLLBACK TO SAVEPOINT %1").arg(name));
+    if (!result.success)
+      qWarning() << "Unable to roll back savepoint: " << result.err.text();
+    _db->executeQueryNoThrow(QStringLiteral("RELEASE SAVEPOINT %1").arg(name));
+  }
+  _active = false;
+  (*_db->_transactionDepth)--;
+}
@@ -0,0 +1,39 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+class DatabaseConnection;
+
+/**
+ * @brief The DatabaseTransaction class is a scope guard for a transaction on a DatabaseConnection.
+ * The transaction is rolled back when the guard goes out of scope, unless commit() was called.
+ * Guards may be nested: the outermost guard opens a real transaction, and each inner guard opens a
+ * savepoint, so an inner rollback only discards the inner guard's work.
+ * Guards must be destroyed in the reverse order that they were created (as happens naturally with
+ * stack allocation)
+ */
+class DatabaseTransaction {
+ public:
+  explicit DatabaseTransaction(DatabaseConnection* db);
+  ~DatabaseTransaction();
+  DatabaseTransaction(const DatabaseTransaction&) = delete;
+  DatabaseTransaction& operator=(const DatabaseTransaction&) = delete;
+
+  /// isActive returns true if the transaction (or savepoint) was started, and has not yet been
+  /// committed or rolled back
+  bool isActive() const { return _active; }
+
+  /// commit makes the changes made within this guard permanent (or, for nested guards, folds them
+  /// into the enclosing transaction). Returns true if successful.
+  bool commit();
+
+  /// rollback discards the changes made within this guard
+  void rollback();
+
+ private:
+  DatabaseConnection* _db;
+  /// _level is 0 for the outermost transaction, and increases for each nested savepoint
+  int _level = 0;
+  bool _active = false;
+};
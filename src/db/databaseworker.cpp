@@ -0,0 +1,146 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#include "databaseworker.h"
+
+DatabaseWorker::DatabaseWorker(const QString& dbPath, const QString& databaseName, int readerCount,
+                               QObject* parent)
+  : QObject(parent)
+  , _dbPath(dbPath)
+  , _dbName(databaseName)
+  , _context(new QObject)
+  , _readerCount(readerCount)
+{
+  _thread.setObjectName(QStringLiteral("%1_db").arg(databaseName));
+  _context->moveToThread(&_thread);
+  connect(&_thread, &QThread::finished, _context, &QObject::deleteLater);
+  _thread.start();
+  QMetaObject::invokeMethod(_context, [this] {
+    _conn = new DatabaseConnection(_dbPath, _dbName);
+  }, Qt::QueuedConnection);
+}
+
+DatabaseWorker::DatabaseWorker(const QString& dbPath, const QString& databaseName, DatabaseWorker* owner)
+  : DatabaseWorker(dbPath, databaseName, 0, owner)
+{
+  _owner = owner;
+}
+
+DatabaseWorker::~DatabaseWorker()
+{
+  // everything queued before this point still executes; afterwards the connection is torn down on
+  // the thread that owns it.
+  QMetaObject::invokeMethod(_context, [this] {
+    _conn->close();
+    delete _conn;
+    _conn = nullptr;
+  }, Qt::BlockingQueuedConnection);
+  _thread.quit();
+  _thread.wait();
+}
+
+QFuture<DatabaseResult> DatabaseWorker::open()
+{
+  auto walMode = std::make_shared<bool>(false);
+  return runAction([this, walMode](DatabaseConnection* conn) {
+    auto onMigrationProgress = [this](const QString& migrationName, int percentDone) {
+      Q_EMIT migrationProgress(migrationName, percentDone);
+    };
+    if (!conn->connect(onMigrationProgress))
+      return false;
+    conn->indexPendingCodeblocks();
+    *walMode = conn->journalMode() == QStringLiteral("wal");
+    return true;
+  }).then(this, [this, walMode](const DatabaseResult& result) {
+    // readers only run alongside the writer (rather than waiting on it) in WAL mode, which is
+    // checked here rather than assumed from the configuration, as sqlite may refuse it
+    if (!result.success || _readerCount == 0 || !_readers.isEmpty())
+      return result;
+    if (!*walMode) {
+      qInfo() << "Database is not in WAL mode; reads share the writer's connection";
+      return result;
+    }
+    for (int i = 1; i <= _readerCount; i++)
+      _readers.append(new DatabaseWorker(_dbPath, QStringLiteral("%1_reader_%2").arg(_dbName).arg(i), this));
+    return result;
+  });
+}
+
+DatabaseConnection* DatabaseWorker::connection()
+{
+  if (_owner && !_conn->isOpen() && !_conn->connectReadOnly())
+    qWarning() << "Unable to open reader" << _dbName << ":" << _conn->errorString();
+  return _conn;
+}
+
+QFuture<model::Evidence> DatabaseWorker::getEvidenceDetails(qint64 evidenceID)
+{
+  return runRead([evidenceID](DatabaseConnection* conn) {
+    return conn->getEvidenceDetails(evidenceID);
+  });
+}
+
+QFuture<QList<model::Evidence>> DatabaseWorker::getEvidenceWithFilters(const EvidenceFilters& filters)
+{
+  return runRead([filters](DatabaseConnection* conn) {
+    auto evidence = conn->getEvidenceWithFilters(filters);
+    if (conn->lastError().type() != QSqlError::NoError)
+      qWarning() << "Could not retrieve evidence. Error: " << conn->lastError().text();
+    return evidence;
+  });
+}
+
+QFuture<EvidencePage> DatabaseWorker::getEvidencePage(const EvidenceFilters& filters,
+                                                     const EvidencePageKey& after, int pageSize)
+{
+  return runRead([filters, after, pageSize](DatabaseConnection* conn) {
+    auto page = conn->getEvidencePage(filters, after, pageSize);
+    if (conn->lastError().type() != QSqlError::NoError)
+      qWarning() << "Could not retrieve evidence. Error: " << conn->lastError().text();
+    return page;
+  });
+}
+
+QFuture<qint64> DatabaseWorker::createEvidence(const QString& filepath, const QString& operationSlug,
+                                               const QString& contentType)
+{
+  return run([filepath, operationSlug, contentType](DatabaseConnection* conn) {
+    return conn->createEvidence(filepath, operationSlug, contentType);
+  });
+}
+
+QFuture<bool> DatabaseWorker::setEvidenceTags(const QList<model::Tag>& newTags, qint64 evidenceID)
+{
+  return run([newTags, evidenceID](DatabaseConnection* conn) {
+    return conn->setEvidenceTags(newTags, evidenceID);
+  });
+}
+
+QFuture<bool> DatabaseWorker::updateEvidenceError(const QString& errorText, qint64 evidenceID)
+{
+  return run([errorText, evidenceID](DatabaseConnection* conn) {
+    return conn->updateEvidenceError(errorText, evidenceID);
+  });
+}
+
+QFuture<void> DatabaseWorker::updateEvidenceSubmitted(qint64 evidenceID)
+{
+  return run([evidenceID](DatabaseConnection* conn) {
+    conn->updateEvidenceSubmitted(evidenceID);
+  });
+}
+
+QFuture<DatabaseResult> DatabaseWorker::deleteEvidence(qint64 evidenceID)
+{
+  return deleteEvidence(QList<qint64>{evidenceID});
+}
+
+QFuture<DatabaseResult> DatabaseWorker::deleteEvidence(const QList<qint64>& evidenceIDs)
+{
+  return runAction([this, evidenceIDs](DatabaseConnection* conn) {
+    bool success = conn->deleteEvidence(evidenceIDs);
+    if (success)
+      Q_EMIT evidenceDeleted();
+    return success;
+  });
+}
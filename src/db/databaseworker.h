@@ -0,0 +1,163 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+#include <QFuture>
+#include <QObject>
+#include <QPromise>
+#include <QThread>
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+#include "databaseconnection.h"
+
+/// DatabaseResult is the outcome of a database action that either succeeds or fails, along with
+/// the error the action itself ran into
+struct DatabaseResult {
+  bool success = false;
+  /// errorText is populated when the action failed
+  QString errorText;
+};
+
+/**
+ * @brief The DatabaseWorker class owns the primary DatabaseConnection on a dedicated thread.
+ * Qt only allows a connection to be used on the thread that created it, so every interaction with
+ * the primary database is queued onto this thread, and the result is handed back as a QFuture.
+ * Callers should receive results via QFuture::then(context, ...), which runs the continuation on
+ * the context object's (typically the GUI) thread. Actions are executed in the order they are queued.
+ *
+ * A worker may also own a pool of reader workers, each with its own read-only connection on its own
+ * thread. Reads queued with runRead are spread over the readers, so long reads (e.g. large filter
+ * queries) neither wait behind, nor hold up, writes such as new captures. This relies on WAL.
+ */
+class DatabaseWorker : public QObject {
+  Q_OBJECT
+
+ public:
+  /// defaultReaderCount is the number of readers to use when the database is in WAL mode
+  inline static const int defaultReaderCount = 2;
+
+  /**
+   * @brief DatabaseWorker starts the worker thread and creates the connection on it. The connection
+   * is not opened until open() is called.
+   * @param dbPath - Path to the database
+   * @param databaseName - Name of the database connection
+   * @param readerCount - Number of reader workers to start once open() finds the database in WAL
+   * mode. Readers are named <databaseName>_reader_<n>. With no readers, runRead uses this worker's
+   * connection.
+   */
+  DatabaseWorker(const QString& dbPath, const QString& databaseName = Constants::defaultDbName,
+                 int readerCount = 0, QObject* parent = nullptr);
+  ~DatabaseWorker();
+
+  /// open connects to (and migrates) the database. Readers are started once the database is open,
+  /// and only if the journal mode in effect is WAL; they connect on their first read.
+  /// Migration progress is reported through migrationProgress.
+  QFuture<DatabaseResult> open();
+
+  /// databasePath returns the path to the underlying database file. Safe to call from any thread.
+  QString databasePath() const { return _dbPath; }
+
+  /**
+   * @brief run queues an action to execute on the worker thread. The action receives the worker's
+   * DatabaseConnection, and whatever it returns becomes the result of the returned future.
+   * Note: the action must not capture anything that is only safe to use on the calling thread
+   * (e.g. widgets); copy the needed values into the lambda instead.
+   */
+  template <typename Func>
+  auto run(Func action) -> QFuture<std::invoke_result_t<Func, DatabaseConnection*>> {
+    using Result = std::invoke_result_t<Func, DatabaseConnection*>;
+    auto promise = std::make_shared<QPromise<Result>>();
+    auto future = promise->future();
+    promise->start();
+    QMetaObject::invokeMethod(_context, [this, promise, action]() {
+      auto conn = connection();
+      if constexpr (std::is_void_v<Result>) {
+        action(conn);
+      }
+      else {
+        promise->addResult(action(conn));
+      }
+      promise->finish();
+    }, Qt::QueuedConnection);
+    return future;
+  }
+
+  /**
+   * @brief runAction is run, for an action that returns whether it succeeded. A failed action's
+   * error is read as part of the action, so it is never confused with that of another action.
+   */
+  template <typename Func>
+  QFuture<DatabaseResult> runAction(Func action) {
+    return run([action](DatabaseConnection* conn) {
+      conn->clearError();
+      DatabaseResult result;
+      result.success = action(conn);
+      if (!result.success)
+        result.errorText = conn->errorString();
+      return result;
+    });
+  }
+
+  /**
+   * @brief runRead queues an action on one of the reader workers, or on this worker if there are
+   * none. The action must only read: reader connections are opened read-only. Reads queued after a
+   * write has completed see that write; reads are not ordered with respect to each other.
+   */
+  template <typename Func>
+  auto runRead(Func action) -> QFuture<std::invoke_result_t<Func, DatabaseConnection*>> {
+    if (_readers.isEmpty())
+      return run(action);
+    auto reader = _readers.at(int(_nextReader++ % unsigned(_readers.size())));
+    return reader->run(action);
+  }
+
+  // Shorthands for the common (single call) interactions. See DatabaseConnection for details.
+  // The getters read through runRead.
+  QFuture<model::Evidence> getEvidenceDetails(qint64 evidenceID);
+  QFuture<QList<model::Evidence>> getEvidenceWithFilters(const EvidenceFilters& filters);
+  QFuture<EvidencePage> getEvidencePage(const EvidenceFilters& filters, const EvidencePageKey& after,
+                                        int pageSize);
+  QFuture<qint64> createEvidence(const QString& filepath, const QString& operationSlug,
+                                 const QString& contentType);
+  QFuture<bool> setEvidenceTags(const QList<model::Tag>& newTags, qint64 evidenceID);
+  QFuture<bool> updateEvidenceError(const QString& errorText, qint64 evidenceID);
+  QFuture<void> updateEvidenceSubmitted(qint64 evidenceID);
+  QFuture<DatabaseResult> deleteEvidence(qint64 evidenceID);
+  QFuture<DatabaseResult> deleteEvidence(const QList<qint64>& evidenceIDs);
+
+ Q_SIGNALS:
+  /// migrationProgress is emitted (from the worker thread) while open() applies pending
+  /// migrations. See DatabaseConnection::MigrationProgressCallback
+  void migrationProgress(const QString& migrationName, int percentDone);
+  /// evidenceDeleted is emitted after evidence is deleted through deleteEvidence, letting the
+  /// EvidenceCollector know there is something to clean up
+  void evidenceDeleted();
+
+ private:
+  /// DatabaseWorker (reader) creates a read-only worker, owned by owner
+  DatabaseWorker(const QString& dbPath, const QString& databaseName, DatabaseWorker* owner);
+
+  /// connection returns the worker's connection, opening it first if this is a reader that has
+  /// not connected yet. Only called on the worker thread.
+  DatabaseConnection* connection();
+
+  QString _dbPath;
+  QString _dbName;
+  QThread _thread;
+  /// _context lives on the worker thread; queued actions are delivered through it.
+  QObject* _context = nullptr;
+  /// _conn is created, used and destroyed exclusively on the worker thread.
+  DatabaseConnection* _conn = nullptr;
+
+  /// _owner is the worker that created this reader; null for every other worker
+  DatabaseWorker* _owner = nullptr;
+  /// _readerCount is the number of readers open() starts in WAL mode
+  int _readerCount = 0;
+  /// _readers are owned (as children) by this worker. Only changed by open(), before any reads.
+  QList<DatabaseWorker*> _readers;
+  std::atomic<unsigned> _nextReader{0};
+};
@@ -0,0 +1,120 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#include "evidencecollector.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+
+#include "databaseworker.h"
+
+EvidenceCollector::EvidenceCollector(DatabaseWorker* db, QObject* parent)
+  : QObject(parent)
+  , db(db)
+{
+  idleTimer.setSingleShot(true);
+  idleTimer.setInterval(idleDelayMs);
+  connect(&idleTimer, &QTimer::timeout, this, &EvidenceCollector::startCollection);
+  connect(db, &DatabaseWorker::evidenceDeleted, this, &EvidenceCollector::collectSoon);
+}
+
+void EvidenceCollector::collectSoon()
+{
+  if (collecting) {
+    rerun = true;
+    return;
+  }
+  idleTimer.start(); // restarting the timer pushes the collection back while deletes keep happening
+}
+
+void EvidenceCollector::startCollection()
+{
+  collecting = true;
+  rerun = false;
+  purged = 0;
+  deferred = 0;
+  notRemoved.clear();
+  cutoff = QDateTime::currentMSecsSinceEpoch();
+  collectBatch();
+}
+
+void EvidenceCollector::collectBatch()
+{
+  auto before = cutoff;
+  db->run([before](DatabaseConnection* conn) {
+    return conn->getDeletedEvidence(before, batchSize);
+  }).then(QtFuture::Launch::Async, [](const QList<model::Evidence>& batch) {
+    return removeFiles(batch);
+  }).then(this, [this](const CollectedBatch& batch) {
+    if (batch.removed.isEmpty() && batch.failed.isEmpty()) {
+      finishCollection();
+      return;
+    }
+    db->runAction([batch](DatabaseConnection* conn) {
+      // a failed purge leaves the records marked, so they are simply collected again next time
+      bool success = batch.removed.isEmpty() || conn->purgeEvidence(batch.removed);
+      if (!batch.failed.isEmpty())
+        success = conn->deferPurge(batch.failed) && success;
+      return success;
+    }).then(this, [this, batch](const DatabaseResult& purgeResult) {
+      if (!purgeResult.success) {
+        qWarning() << "Unable to purge deleted evidence. Error:" << purgeResult.errorText;
+        finishCollection();
+        return;
+      }
+      purged += batch.removed.size();
+      deferred += batch.failed.size();
+      for (qint64 id : batch.removed)
+        reportedFailures.remove(id);
+      for (int i = 0; i < batch.failed.size(); ++i) {
+        if (!reportedFailures.contains(batch.failed.at(i))) {
+          reportedFailures.insert(batch.failed.at(i));
+          notRemoved.append(batch.failedFiles.at(i));
+        }
+      }
+      if (batch.full)
+        QTimer::singleShot(batchDelayMs, this, &EvidenceCollector::collectBatch);
+      else
+        finishCollection();
+    });
+  });
+}
+
+void EvidenceCollector::finishCollection()
+{
+  collecting = false;
+  if (purged > 0 || deferred > 0)
+    qInfo() << "Purged" << purged << "deleted evidence;" << deferred << "deferred";
+  if (!notRemoved.isEmpty())
+    Q_EMIT filesNotRemoved(notRemoved);
+  Q_EMIT collectionFinished(purged, deferred);
+  if (rerun)
+    collectSoon();
+}
+
+EvidenceCollector::CollectedBatch EvidenceCollector::removeFiles(const QList<model::Evidence>& batch)
+{
+  CollectedBatch rtn;
+  rtn.full = batch.size() == batchSize;
+  QSet<QString> parentDirs;
+  for (const auto& evi : batch) {
+    QFile file(evi.path);
+    // a file that is already gone (e.g. removed by hand) needs no further work
+    if (evi.path.isEmpty() || !file.exists() || file.remove()) {
+      rtn.removed.append(evi.id);
+      if (!evi.path.isEmpty())
+        parentDirs.insert(QFileInfo(evi.path).absolutePath());
+      continue;
+    }
+    qWarning() << "Unable to remove deleted evidence file" << evi.path << ":" << file.errorString();
+    rtn.failed.append(evi.id);
+    rtn.failedFiles.append(QStringLiteral("%1 (%2)").arg(evi.path, file.errorString()));
+  }
+  // evidence is grouped into per-operation directories; remove any that are now empty
+  for (const auto& dirPath : parentDirs)
+    QDir().rmdir(dirPath);
+  return rtn;
+}
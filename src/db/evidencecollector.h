@@ -0,0 +1,73 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+#include "models/evidence.h"
+
+class DatabaseWorker;
+
+/**
+ * @brief The EvidenceCollector class finishes what DatabaseConnection::deleteEvidence starts.
+ * Deleting evidence only marks the record; once the application has been quiet for a while, the
+ * collector removes the marked evidence files (off of the GUI thread), then purges the records and
+ * their tags, a batch at a time. Evidence whose file cannot be removed is retried on a later pass.
+ */
+class EvidenceCollector : public QObject {
+  Q_OBJECT
+
+ public:
+  /// EvidenceCollector schedules a collection whenever db reports that evidence was deleted.
+  /// db must outlive the collector (e.g. make db the parent).
+  EvidenceCollector(DatabaseWorker* db, QObject* parent = nullptr);
+
+  /// collectSoon schedules a collection once no further deletes have happened for idleDelayMs.
+  /// If a collection is running, another one follows it.
+  void collectSoon();
+
+ Q_SIGNALS:
+  /// collectionFinished is emitted when a collection completes, with the number of evidence purged
+  /// and the number deferred to a later collection
+  void collectionFinished(int purged, int deferred);
+  /// filesNotRemoved is emitted when a collection completes, listing each evidence file that could
+  /// not be removed (as "path (reason)"). A file is only listed the first time its removal fails.
+  void filesNotRemoved(const QStringList& files);
+
+ private:
+  /// CollectedBatch splits a batch of deleted evidence by whether its file is now gone
+  struct CollectedBatch {
+    QList<qint64> removed;
+    QList<qint64> failed;
+    /// failedFiles describes each failed removal, in the same order as failed
+    QStringList failedFiles;
+    bool full = false;
+  };
+
+  void startCollection();
+  void collectBatch();
+  void finishCollection();
+  /// removeFiles removes the file (and now empty directory) of each evidence. Runs on the thread pool.
+  static CollectedBatch removeFiles(const QList<model::Evidence>& batch);
+
+  inline static const int idleDelayMs = 10000;
+  inline static const int batchDelayMs = 1000;
+  inline static const int batchSize = 200;
+
+  DatabaseWorker* db = nullptr;
+  QTimer idleTimer;
+  bool collecting = false;
+  bool rerun = false;
+  /// cutoff excludes evidence deleted (or deferred) after the current collection started
+  qint64 cutoff = 0;
+  int purged = 0;
+  int deferred = 0;
+  /// notRemoved lists the files newly found to be stuck during the current collection
+  QStringList notRemoved;
+  /// reportedFailures holds the evidence whose stuck file has already been reported
+  QSet<qint64> reportedFailures;
+};
@@ -0,0 +1,23 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#include "evidencecursor.h"
+
+#include "databaseconnection.h"
+
+EvidenceCursor::EvidenceCursor(DatabaseConnection* db, const EvidenceFilters& filters, int pageSize)
+  : _db(db)
+  , _filters(filters)
+  , _pageSize(pageSize > 0 ? pageSize : defaultPageSize)
+{
+}
+
+QList<model::Evidence> EvidenceCursor::nextPage()
+{
+  if (_atEnd)
+    return {};
+  auto page = _db->getEvidencePage(_filters, _position, _pageSize);
+  _position = page.next;
+  _atEnd = page.atEnd;
+  return page.evidence;
+}
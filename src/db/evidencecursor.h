@@ -0,0 +1,52 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+#include <QList>
+
+#include "forms/evidence_filter/evidencefilter.h"
+#include "models/evidence.h"
+
+class DatabaseConnection;
+
+/// EvidencePageKey marks a position in the (recorded_ms, id) ordering of evidence
+struct EvidencePageKey {
+  qint64 recordedMs = 0;
+  qint64 id = -1;
+  bool isValid() const { return id != -1; }
+};
+
+/// EvidencePage is a single page of filtered evidence, along with where the next page starts
+struct EvidencePage {
+  QList<model::Evidence> evidence;
+  /// next is the key of the last row in this page; pass this to retrieve the following page
+  EvidencePageKey next;
+  bool atEnd = true;
+};
+
+/**
+ * @brief The EvidenceCursor class walks all evidence matching a filter, one page at a time, so
+ * that callers only hold a single page in memory. Pages are keyed on (recorded_ms, id) rather
+ * than an offset, so each page costs the same to fetch no matter how far in it is.
+ * Rows inserted behind the cursor while it is being walked are not returned.
+ */
+class EvidenceCursor {
+ public:
+  inline static const int defaultPageSize = 500;
+
+  EvidenceCursor(DatabaseConnection* db, const EvidenceFilters& filters,
+                 int pageSize = defaultPageSize);
+
+  /// nextPage retrieves the next page of evidence. Returns an empty list once the end is reached.
+  QList<model::Evidence> nextPage();
+  /// atEnd returns true once every matching row has been returned
+  bool atEnd() const { return _atEnd; }
+
+ private:
+  DatabaseConnection* _db;
+  EvidenceFilters _filters;
+  int _pageSize;
+  EvidencePageKey _position;
+  bool _atEnd = false;
+};
@@ -0,0 +1,44 @@
+// Generated by bin/update_migration_resource.py. Do not edit.
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+#include <array>
+
+/// MigrationManifestEntry names a migration (relative to :/migrations) and the sha256 of its content
+struct MigrationManifestEntry {
+  const char* name;
+  const char* sha256;
+};
+
+/// migrationManifest lists every migration, in the order they must be applied
+inline constexpr std::array<MigrationManifestEntry, 28> migrationManifest {{
+    {"20200521190124-initial.sql", "d1025da32377254d6c8fc8bf5766c12568c09c69db3bb3a2c1aecd385795db20"},
+    {"20200521210407-add-screenshots-table.sql", "7a86551fb3efc354c5255f84e8a4ac27319bfae806323a57b411e31849c20835"},
+    {"20200521210435-add-tags-table.sql", "a864864f8172efb4d7a63b548677bc143fa5bae53eeb8b557fec638c9cbc634e"},
+    {"20200625191727-support-codeblocks-p1.sql", "e26640f7eaef504de7b4a3a724cc5f025df1e6ed08df74303130baf7df302d9e"},
+    {"20200625192018-support-codeblocks-p2.sql", "c986c56c7c9b1769d93c39bda6998cdf35c4940b9ac2e86383fdd36f8940deb9"},
+    {"20200625192444-support-codeblocks-p3.sql", "719a4c148f40cc14a86ac784ab3050e379b644c9760625475504615dc9065aa2"},
+    {"20200625203249-support-codeblocks-p4.sql", "72acf7df1d1d76a4b53c49ae7d921f42e0bccc9644b6bd5260471191f9ef6f42"},
+    {"20261017110000-add-evidence-fts.sql", "ac59eed7adbea3e8d47812f0660ffb5617f6521b83fc692915622614ea61a1ca"},
+    {"20261017110002-add-evidence-fts-delete-trigger.sql", "43c12531c3c531924b05a0ec8144cde4238d3ae483b69d686f6dfe3a40600383"},
+    {"20261017120000-add-evidence-recorded-ms.sql", "3ede795041575d94228510f0a94a25b5911e0866c7447bdd173f75254c8ae150"},
+    {"20261017120001-add-evidence-upload-ms.sql", "9e5faea80c2e95a3b7124146f72c07acd89cd2b4ca414d7f449c9eb7cdf199f9"},
+    {"20261017120003-index-evidence-operation-recorded-ms.sql", "011c967cd44fa3aeeff93d91387b509c8f16dd6db22c65e917dea290cb61bb2e"},
+    {"20261017120004-index-evidence-operation-content-ms.sql", "4bd9b7f418e7aa3a85cfc7913b27a531d41c1449898a56a1d6d5b18b39b99cf9"},
+    {"20261017120005-index-evidence-recorded-ms.sql", "fb2200bb1e568eb75914e63b108ebd38bafa344d2049ba89de3f3a75b34982b7"},
+    {"20261017130000-add-evidence-deleted-at.sql", "dfa2aa813ad38d56d96e65bb1e3f375208d35bafe4f3845851cdb04eae9a7198"},
+    {"20261017130001-index-evidence-deleted-at.sql", "fe04f5fbeb45895c3d6062e26eae7f7d2fc58e4f59093cdf7c85773a39b71a2d"},
+    {"20261017140000-add-tag-dictionary-table.sql", "3d54eabb81e563a4b7e43a6883e921baa771395239c462288876fa94f628e3a9"},
+    {"20261017140001-add-evidence-tags-table.sql", "dcf4cebf87c2660b114f133c0cf4751c726da435617c738efb673b128d084296"},
+    {"20261017140002-index-evidence-tags-tag.sql", "28c92d865b065c21c930040f8bf5454ae0e862d1b188fa8f7b56ecc87485c37d"},
+    {"20261017145000-add-migrations-progress.sql", "c517edd6f5432663c18ff80619e43618b48841478ef2cd7200b24a0f4f1a4fb7"},
+    {"20261017150000-backfill-evidence-epoch-ms.sql", "caed95cb20f8d36af2ed0d691ef08c18e52749526fbd52c240bc14d2c9f4c72b"},
+    {"20261017150001-backfill-evidence-fts.sql", "9b9cf254e98226012741fed8b8518762488b6f243c09d11911884a403d8c7b22"},
+    {"20261017150002-backfill-tag-dictionary.sql", "bd415bb9abf5c913656014ddc9396212b5d4f9bc943855207d9ffc249b6af87c"},
+    {"20261017150003-backfill-evidence-tags.sql", "16f9f78d68ddc5353286744e3584ea1ab830f57b2a5550762c9339b2f0a16c12"},
+    {"20261017150004-clear-tags-table.sql", "b7bc868fe05c676f965776f426685238354581eedbb400f32496e6187042452f"},
+    {"20261017170000-add-upload-queue-table.sql", "047a8d2bc1eb7d954f1ca7e846a1696fd7e2d248f379a10430378b2fca3bc95d"},
+    {"20261017170001-index-upload-queue-next-attempt.sql", "064a1184d751708c4b4e8c125466c15ac559f4e080279f66b8c232ffbf24ad22"},
+    {"20261017180000-add-tag-outbox-table.sql", "bef7638749b9841074a68bda18165cc40aa0aa040cb9e11a85897fd4256d0684"},
+}};
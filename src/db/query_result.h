@@ -3,6 +3,8 @@
 #include <QSqlError>
 #include <QSqlQuery>
 
+#include <memory>
+
 
 /**
  * @brief The QueryResult class is a small container for representing a post "query.exec" state
@@ -12,8 +14,8 @@
 class QueryResult {
  public:
   QueryResult(){}
-  QueryResult(QSqlQuery query) {
-    this->err = query.lastError();
+  QueryResult(std::shared_ptr<QSqlQuery> query) {
+    this->err = query->lastError();
     this->query = std::move(query);
     this->success = err.type() == QSqlError::NoError;
   }
@@ -21,8 +23,9 @@ class QueryResult {
  public:
   /// success is a shorthand to determine if the last error was actually NoError
   bool success = false;
-  /// query is the result of the underlying query, in whatever state it is in
-  QSqlQuery query;
+  /// query is the result of the underlying query, in whatever state it is in. The query may be a
+  /// cached statement, so it should not be held past the current operation.
+  std::shared_ptr<QSqlQuery> query;
 
   /// err is a shorthand for QSqlQuery.lastError()
   QSqlError err;
@@ -0,0 +1,135 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#include "querystats.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QRegularExpression>
+
+#include <algorithm>
+
+void QueryStats::record(const QString& stmt, qint64 elapsedUs, qint64 rows)
+{
+  QMutexLocker lock(&_lock);
+  auto fp = _fingerprints.value(stmt);
+  if (fp.isNull()) {
+    if (_fingerprints.size() >= _maxCachedFingerprints)
+      _fingerprints.clear();
+    fp = fingerprint(stmt);
+    _fingerprints.insert(stmt, fp);
+  }
+
+  auto& entry = _stats[fp];
+  if (entry.calls == 0)
+    entry.fingerprint = fp;
+  entry.calls++;
+  entry.totalUs += elapsedUs;
+  entry.maxUs = std::max(entry.maxUs, elapsedUs);
+  entry.rows += std::max<qint64>(rows, 0);
+  auto bucket = std::upper_bound(bucketLimitsUs.begin(), bucketLimitsUs.end(), elapsedUs) - bucketLimitsUs.begin();
+  entry.histogram[bucket]++;
+
+  if (_slowThresholdMs >= 0 && elapsedUs >= qint64(_slowThresholdMs) * 1000) {
+    qWarning().noquote() << QStringLiteral("Slow query (%1 ms, %2 rows): %3")
+                                .arg(QString::number(elapsedUs / 1000.0, 'f', 1), QString::number(rows), fp);
+  }
+}
+
+void QueryStats::setSlowThresholdMs(int thresholdMs)
+{
+  QMutexLocker lock(&_lock);
+  _slowThresholdMs = thresholdMs;
+}
+
+int QueryStats::slowThresholdMs() const
+{
+  QMutexLocker lock(&_lock);
+  return _slowThresholdMs;
+}
+
+QList<QueryStats::StatementStats> QueryStats::snapshot() const
+{
+  QList<StatementStats> rtn;
+  {
+    QMutexLocker lock(&_lock);
+    rtn = _stats.values();
+  }
+  std::sort(rtn.begin(), rtn.end(), [](const StatementStats& a, const StatementStats& b) {
+    return a.totalUs > b.totalUs;
+  });
+  return rtn;
+}
+
+void QueryStats::reset()
+{
+  QMutexLocker lock(&_lock);
+  _stats.clear();
+}
+
+QByteArray QueryStats::toJson() const
+{
+  QJsonArray limits;
+  for (auto limit : bucketLimitsUs)
+    limits.append(limit);
+
+  QJsonArray statements;
+  for (const auto& entry : snapshot()) {
+    QJsonArray histogram;
+    for (auto count : entry.histogram)
+      histogram.append(qint64(count));
+    statements.append(QJsonObject{
+        {QStringLiteral("fingerprint"), entry.fingerprint},
+        {QStringLiteral("calls"), qint64(entry.calls)},
+        {QStringLiteral("totalUs"), entry.totalUs},
+        {QStringLiteral("maxUs"), entry.maxUs},
+        {QStringLiteral("rows"), entry.rows},
+        {QStringLiteral("histogram"), histogram},
+    });
+  }
+  QJsonObject root{
+      {QStringLiteral("bucketLimitsUs"), limits},
+      {QStringLiteral("statements"), statements},
+  };
+  return QJsonDocument(root).toJson();
+}
+
+QByteArray QueryStats::toCsv() const
+{
+  QStringList header{QStringLiteral("fingerprint"), QStringLiteral("calls"), QStringLiteral("total_us"),
+                     QStringLiteral("max_us"), QStringLiteral("rows")};
+  for (auto limit : bucketLimitsUs)
+    header.append(QStringLiteral("lt_%1us").arg(limit));
+  header.append(QStringLiteral("ge_%1us").arg(bucketLimitsUs.back()));
+
+  QStringList lines{header.join(QLatin1Char(','))};
+  for (const auto& entry : snapshot()) {
+    auto quoted = entry.fingerprint;
+    quoted.replace(QLatin1Char('"'), QStringLiteral("\"\""));
+    QStringList fields{QStringLiteral("\"%1\"").arg(quoted), QString::number(entry.calls),
+                       QString::number(entry.totalUs), QString::number(entry.maxUs),
+                       QString::number(entry.rows)};
+    for (auto count : entry.histogram)
+      fields.append(QString::number(count));
+    lines.append(fields.join(QLatin1Char(',')));
+  }
+  return lines.join(QLatin1Char('\n')).append(QLatin1Char('\n')).toUtf8();
+}
+
+QString QueryStats::fingerprint(const QString& stmt)
+{
+  static const QRegularExpression numbers(QStringLiteral("\\b\\d+\\b"));
+  // a row is a parenthesized group holding a variable, which may itself contain one level of parens
+  static const QRegularExpression variableRows(QStringLiteral(
+      "(\\((?:[^()]|\\([^()]*\\))*\\?(?:[^()]|\\([^()]*\\))*\\))(?:\\s*,\\s*\\1)+"));
+  static const QRegularExpression variables(QStringLiteral("\\?(?:\\s*,\\s*\\?)+"));
+
+  auto rtn = stmt.simplified();
+  rtn.replace(numbers, QStringLiteral("?"));
+  rtn.replace(variableRows, QStringLiteral("\\1, ..."));
+  rtn.replace(variables, QStringLiteral("?, ..."));
+  return rtn;
+}
@@ -0,0 +1,68 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+#include <array>
+
+/**
+ * @brief The QueryStats class records how long each statement takes, grouped by the statement's
+ * fingerprint: its sql with literals and variable lists collapsed, so that every batch size of the
+ * same batched query shares one entry. Any execution slower than the slow query threshold is
+ * logged as it happens.
+ * Unlike the rest of the database layer, a QueryStats is safe to use from any thread, so that a
+ * single instance can cover every connection.
+ */
+class QueryStats {
+ public:
+  /// bucketLimitsUs is the (exclusive) upper bound, in microseconds, of each histogram bucket but
+  /// the last, which holds everything slower
+  inline static const std::array<qint64, 5> bucketLimitsUs{100, 1000, 10000, 100000, 1000000};
+
+  struct StatementStats {
+    QString fingerprint;
+    quint64 calls = 0;
+    qint64 totalUs = 0;
+    qint64 maxUs = 0;
+    /// rows is the number of rows written (or, for batched selects, read)
+    qint64 rows = 0;
+    std::array<quint64, bucketLimitsUs.size() + 1> histogram{};
+  };
+
+  /**
+   * @brief record adds one execution of stmt to its statement's entry, logging it if it was slow
+   * @param elapsedUs the wall time of the execution, in microseconds
+   * @param rows the rows touched by the execution (negative if unknown)
+   */
+  void record(const QString& stmt, qint64 elapsedUs, qint64 rows);
+
+  /// setSlowThresholdMs sets how long an execution may take before it is logged. -1 disables the log.
+  void setSlowThresholdMs(int thresholdMs);
+  int slowThresholdMs() const;
+
+  /// snapshot returns a copy of every statement's stats, slowest (in total) first
+  QList<StatementStats> snapshot() const;
+  void reset();
+
+  /// toJson renders the current stats as a JSON document
+  QByteArray toJson() const;
+  /// toCsv renders the current stats as CSV, one row per statement
+  QByteArray toCsv() const;
+
+  /// fingerprint normalizes stmt: whitespace is collapsed, numeric literals become ?, and runs of
+  /// variables (or of identical variable rows) are shortened to their first item, followed by "..."
+  static QString fingerprint(const QString& stmt);
+
+ private:
+  mutable QMutex _lock;
+  int _slowThresholdMs = 100;
+  QHash<QString, StatementStats> _stats;
+  /// _fingerprints caches the fingerprint of recently seen statements, as computing it is not free
+  QHash<QString, QString> _fingerprints;
+  inline static const int _maxCachedFingerprints = 1024;
+};
@@ -0,0 +1,71 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#include "rowdecoders.h"
+
+#include <QSqlRecord>
+
+namespace {
+QDateTime utcDateTime(const QSqlQuery& query, int msColumn, int textColumn)
+{
+  if (msColumn != -1) {
+    auto ms = query.value(msColumn);
+    if (!ms.isNull())
+      return QDateTime::fromMSecsSinceEpoch(ms.toLongLong(), Qt::UTC);
+  }
+  if (textColumn == -1)
+    return QDateTime();
+  auto rtn = query.value(textColumn).toDateTime();
+  rtn.setTimeSpec(Qt::UTC);
+  return rtn;
+}
+}
+
+EvidenceRowDecoder::EvidenceRowDecoder(const QSqlQuery& query)
+{
+  const auto record = query.record();
+  _id = record.indexOf(QStringLiteral("id"));
+  _path = record.indexOf(QStringLiteral("path"));
+  _operationSlug = record.indexOf(QStringLiteral("operation_slug"));
+  _contentType = record.indexOf(QStringLiteral("content_type"));
+  _description = record.indexOf(QStringLiteral("description"));
+  _error = record.indexOf(QStringLiteral("error"));
+  _recordedDate = record.indexOf(QStringLiteral("recorded_date"));
+  _uploadDate = record.indexOf(QStringLiteral("upload_date"));
+  _recordedMs = record.indexOf(QStringLiteral("recorded_ms"));
+  _uploadMs = record.indexOf(QStringLiteral("upload_ms"));
+}
+
+model::Evidence EvidenceRowDecoder::decode(const QSqlQuery& query) const
+{
+  model::Evidence evi;
+  evi.id = query.value(_id).toLongLong();
+  evi.path = query.value(_path).toString();
+  evi.operationSlug = query.value(_operationSlug).toString();
+  evi.contentType = query.value(_contentType).toString();
+  evi.description = query.value(_description).toString();
+  evi.errorText = query.value(_error).toString();
+  evi.recordedDate = utcDateTime(query, _recordedMs, _recordedDate);
+  evi.uploadDate = utcDateTime(query, _uploadMs, _uploadDate);
+  return evi;
+}
+
+TagRowDecoder::TagRowDecoder(const QSqlQuery& query)
+{
+  const auto record = query.record();
+  _id = record.indexOf(QStringLiteral("id"));
+  _evidenceId = record.indexOf(QStringLiteral("evidence_id"));
+  _tagId = record.indexOf(QStringLiteral("tag_id"));
+  _name = record.indexOf(QStringLiteral("name"));
+  _color = record.indexOf(QStringLiteral("color"));
+}
+
+model::Tag TagRowDecoder::decode(const QSqlQuery& query) const
+{
+  auto tag = model::Tag(query.value(_id).toLongLong(), query.value(_tagId).toLongLong(),
+                        query.value(_name).toString());
+  tag.evidenceId = _evidenceId == -1 ? 0 : query.value(_evidenceId).toLongLong();
+  if (_color != -1)
+    tag.colorName = query.value(_color).toString();
+  return tag;
+}
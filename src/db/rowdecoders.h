@@ -0,0 +1,52 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+#include <QSqlQuery>
+
+#include "models/evidence.h"
+#include "models/tag.h"
+
+/**
+ * @brief The EvidenceRowDecoder class converts evidence result rows into model::Evidence.
+ * Column positions are resolved by name once, when the decoder is created, and each row is then
+ * read by position. Create one decoder per result set (or per set of identically shaped result
+ * sets), after the query has been executed. Tags are not populated.
+ * Dates are read from the epoch-millisecond columns, falling back to the legacy text columns for
+ * rows that have not been backfilled yet.
+ */
+class EvidenceRowDecoder {
+ public:
+  explicit EvidenceRowDecoder(const QSqlQuery& query);
+  model::Evidence decode(const QSqlQuery& query) const;
+
+ private:
+  int _id;
+  int _path;
+  int _operationSlug;
+  int _contentType;
+  int _description;
+  int _error;
+  int _recordedDate;
+  int _uploadDate;
+  int _recordedMs;
+  int _uploadMs;
+};
+
+/**
+ * @brief The TagRowDecoder class converts tag result rows into model::Tag. As with
+ * EvidenceRowDecoder, columns are resolved once. The evidence_id and color columns are optional.
+ */
+class TagRowDecoder {
+ public:
+  explicit TagRowDecoder(const QSqlQuery& query);
+  model::Tag decode(const QSqlQuery& query) const;
+
+ private:
+  int _id;
+  int _evidenceId;
+  int _tagId;
+  int _name;
+  int _color;
+};
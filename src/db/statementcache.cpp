@@ -0,0 +1,43 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#include "statementcache.h"
+
+SharedQuery StatementCache::acquire(const QSqlDatabase& db, const QString& stmt, bool* prepared)
+{
+  auto found = _index.find(stmt);
+  if (found != _index.end()) {
+    auto entry = found.value();
+    // only the cache holds it: nobody is reading from this statement, so it can be reused
+    if (entry->query.use_count() == 1) {
+      _stats.hits++;
+      _entries.splice(_entries.begin(), _entries, entry);
+      *prepared = true;
+      return entry->query;
+    }
+  }
+
+  _stats.misses++;
+  auto query = std::make_shared<QSqlQuery>(db);
+  // results are only ever read front to back, so sqlite rows don't need to be buffered for seeking
+  query->setForwardOnly(true);
+  *prepared = query->prepare(stmt);
+  // a busy duplicate is left in place; this copy is simply not cached
+  if (!*prepared || found != _index.end() || _capacity <= 0)
+    return query;
+
+  _entries.push_front({stmt, query});
+  _index.insert(stmt, _entries.begin());
+  while (int(_entries.size()) > _capacity) {
+    _index.remove(_entries.back().stmt);
+    _entries.pop_back();
+    _stats.evictions++;
+  }
+  return query;
+}
+
+void StatementCache::clear()
+{
+  _index.clear();
+  _entries.clear();
+}
@@ -0,0 +1,60 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+#include <list>
+#include <memory>
+
+using SharedQuery = std::shared_ptr<QSqlQuery>;
+
+/**
+ * @brief The StatementCache class is a least-recently-used cache of prepared statements, keyed by
+ * their sql text. Reusing a prepared QSqlQuery skips sqlite's statement compilation; the caller
+ * only needs to rebind values and exec.
+ * A cached statement is only handed out when no one else holds it, so a result set that is still
+ * being read is never re-executed underneath its reader.
+ * Like the connection it belongs to, a StatementCache must only be used on a single thread.
+ */
+class StatementCache {
+ public:
+  struct Stats {
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 evictions = 0;
+  };
+
+  explicit StatementCache(int capacity = 32) : _capacity(capacity) {}
+
+  /**
+   * @brief acquire returns a (forward only) query prepared with stmt for the given database,
+   * reusing a cached statement where possible.
+   * @param prepared set to false if stmt failed to prepare. Failed statements are never cached, and
+   * the returned query carries the error.
+   */
+  SharedQuery acquire(const QSqlDatabase& db, const QString& stmt, bool* prepared);
+
+  /// clear drops every cached statement. Must be called before the owning database is closed.
+  void clear();
+
+  Stats stats() const { return _stats; }
+  int size() const { return int(_index.size()); }
+  int capacity() const { return _capacity; }
+
+ private:
+  struct Entry {
+    QString stmt;
+    SharedQuery query;
+  };
+  using EntryList = std::list<Entry>;
+
+  int _capacity;
+  /// _entries is ordered from most to least recently used
+  EntryList _entries;
+  QHash<QString, EntryList::iterator> _index;
+  Stats _stats;
+};
@@ -35,6 +35,7 @@ class Tag {
 
   static Tag fromModelTag(model::Tag tag, QString colorName) {
     Tag t;
+    t.id = tag.serverTagId;
     t.name = tag.tagName;
     t.colorName = colorName;
     return t;
@@ -6,19 +6,22 @@
 #include <QApplication>
 #include <QCheckBox>
 #include <QClipboard>
+#include <QDateTime>
 #include <QGridLayout>
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QPushButton>
-#include <QRandomGenerator>
+#include <QScrollBar>
 #include <QTableWidgetItem>
 
 #include "appconfig.h"
+#include "components/connectivity/connectivitymonitor.h"
+#include "components/upload_queue/uploadqueue.h"
+#include "db/evidencecollector.h"
 #include "dtos/tag.h"
 #include "forms/evidence_filter/evidencefilter.h"
 #include "forms/evidence_filter/evidencefilterform.h"
-#include "helpers/netman.h"
-#include "helpers/cleanupreply.h"
+#include "helpers/file_helpers.h"
 
 enum ColumnIndexes {
   COL_DATE_CAPTURED = 0,
@@ -32,9 +35,12 @@ enum ColumnIndexes {
   COL_ERROR_MSG
 };
 
-EvidenceManager::EvidenceManager(DatabaseConnection* db, QWidget* parent)
+EvidenceManager::EvidenceManager(DatabaseWorker* db, UploadQueue* uploads, EvidenceCollector* collector,
+                                 QWidget* parent)
     : AShirtDialog(parent)
     , db(db)
+    , uploads(uploads)
+    , collector(collector)
     , evidenceTable(new QTableWidget(this))
     , filterForm(new EvidenceFilterForm(this))
     , evidenceTableContextMenu(new QMenu(this))
@@ -48,15 +54,13 @@ EvidenceManager::EvidenceManager(DatabaseConnection* db, QWidget* parent)
     , cancelEditButton(new QPushButton(tr("Cancel"), this))
     , evidenceEditor(new EvidenceEditor(this->db, this))
     , loadingAnimation(new QProgressIndicator(this))
+    , uploadStatusLabel(new QLabel(this))
+    , uploadStatsTimer(new QTimer(this))
 {
   buildUi();
   wireUi();
 }
 
-EvidenceManager::~EvidenceManager() {
-  cleanUpReply(&uploadAssetReply);
-}
-
 void EvidenceManager::buildEvidenceTableUi() {
   evidenceTable->setContextMenuPolicy(Qt::CustomContextMenu);
   evidenceTable->setColumnCount(columnNames.length());
@@ -78,6 +82,7 @@ void EvidenceManager::buildUi() {
   evidenceTableContextMenu->addAction(tr("Delete Evidence"), this, &EvidenceManager::deleteEvidenceTriggered);
   evidenceTableContextMenu->addAction(copyPathToClipboardAction);
   evidenceTableContextMenu->addSeparator();
+  evidenceTableContextMenu->addAction(tr("Submit All from table"), this, &EvidenceManager::submitAllTriggered);
   evidenceTableContextMenu->addAction(tr("Delete All from table"), this , &EvidenceManager::deleteAllTriggered);
 
   cancelEditButton->setVisible(false);
@@ -92,6 +97,9 @@ void EvidenceManager::buildUi() {
   // apply a default for apply-filter, which is the typical action
   applyFilterButton->setDefault(true);
 
+  uploadStatusLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+  uploadStatsTimer->setInterval(uploadStatsIntervalMs);
+
   buildEvidenceTableUi();
 
   evidenceEditor->setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding));
@@ -114,7 +122,7 @@ void EvidenceManager::buildUi() {
        |                     Evidence Editor                    |
        |                                                        |
        +---------------+-------------+------------+-------------+
-    3  | Loading Ani   | Hor Spacer  | Cancel Btn | Edit Btn    |
+    3  | Loading Ani   | Upload Stat | Cancel Btn | Edit Btn    |
        +---------------+-------------+------------+-------------+
   */
 
@@ -130,7 +138,7 @@ void EvidenceManager::buildUi() {
   gridLayout->addWidget(evidenceEditor, 2, 0, 1, gridLayout->columnCount());
 
   gridLayout->addWidget(loadingAnimation, 3, 0);
-  gridLayout->addItem(new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Minimum), 3, 1);
+  gridLayout->addWidget(uploadStatusLabel, 3, 1);
   gridLayout->addWidget(cancelEditButton, 3, 2);
   gridLayout->addWidget(editButton, 3, 3);
   setLayout(gridLayout);
@@ -160,15 +168,34 @@ void EvidenceManager::wireUi() {
   connect(evidenceTable, &QTableWidget::currentCellChanged, this, &EvidenceManager::onRowChanged);
   connect(evidenceTable, &QTableWidget::customContextMenuRequested, this,
           &EvidenceManager::openTableContextMenu);
+
+  connect(uploads, &UploadQueue::uploadsQueued, this, &EvidenceManager::onUploadsQueued);
+  connect(uploads, &UploadQueue::uploadStarted, this, &EvidenceManager::onUploadStarted);
+  connect(uploads, &UploadQueue::uploadSucceeded, this, &EvidenceManager::onUploadSucceeded);
+  connect(uploads, &UploadQueue::uploadFailed, this, &EvidenceManager::onUploadFailed);
+  connect(collector, &EvidenceCollector::filesNotRemoved, this, &EvidenceManager::onFilesNotRemoved);
+  connect(ConnectivityMonitor::get(), &ConnectivityMonitor::onlineChanged, this, &EvidenceManager::updateUploadStats);
+  connect(uploadStatsTimer, &QTimer::timeout, this, &EvidenceManager::updateUploadStats);
+  connect(evidenceTable->verticalScrollBar(), &QScrollBar::valueChanged, this, &EvidenceManager::loadMoreIfNeeded);
+  connect(evidenceTable->verticalScrollBar(), &QScrollBar::rangeChanged, this, &EvidenceManager::loadMoreIfNeeded);
 }
 
 void EvidenceManager::editEvidenceButtonClicked() {
   if(editButton->text() == tr("Save")) {
-    evidenceEditor->saveEvidence();
-    cancelEditEvidenceButtonClicked();
-    refreshRow(evidenceTable->currentRow());
-    // restore default form action
-    applyFilterButton->setDefault(true);
+    // reads run on the reader pool, so the row refresh (in saveData) and the revert both wait for
+    // the save to be written
+    auto saved = saveData();
+    evidenceEditor->setEnabled(false); // the edits are captured; no more until the save is written
+    saved.then(this, [this](bool success) {
+      if (!success) {
+        // saveData has shown the error; the edits stay open, so they can be saved again
+        evidenceEditor->setEnabled(true);
+        return;
+      }
+      cancelEditEvidenceButtonClicked();
+      // restore default form action
+      applyFilterButton->setDefault(true);
+    });
   }
   else {
     // remove default form action to prevent accidental reloading of evidence
@@ -191,25 +218,51 @@ void EvidenceManager::showEvent(QShowEvent* evt) {
   QDialog::showEvent(evt);
   evidenceEditor->updateEvidence(-1, true);
   resetFilterButtonClicked();
+  updateUploadStats();
 }
 
 void EvidenceManager::submitEvidenceTriggered()
 {
-    loadingAnimation->startAnimation();
-    evidenceTable->setEnabled(false);  // prevent switching evidence while one is being submitted.
-    if (!saveData())
-        return;
-    evidenceIDForRequest = selectedRowEvidenceID();
-    model::Evidence evi = db->getEvidenceDetails(evidenceIDForRequest);
-    if(evi.id == -1) {
-        evidenceTable->setEnabled(true);
-        loadingAnimation->stopAnimation();
-        QMessageBox::warning(this, tr("Cannot submit evidence"),
-                             tr("Could not retrieve data. Please try again."));
+    auto ids = selectedRowEvidenceIDs();
+    if (ids.size() != 1) {
+        submitSet(ids);
         return;
     }
-    uploadAssetReply = NetMan::uploadAsset(evi);
-    connect(uploadAssetReply, &QNetworkReply::finished, this, &EvidenceManager::onUploadComplete);
+    // a single item may be open in the editor, so its edits are saved first
+    saveData().then(this, [this, ids](bool saved) {
+        if (saved)
+            submitSet(ids);
+    });
+}
+
+void EvidenceManager::submitAllTriggered()
+{
+    auto filter = EvidenceFilters::parseFilter(filterTextBox->text());
+    db->runRead([filter](DatabaseConnection* conn) {
+        return conn->getEvidenceIDsWithFilters(filter);
+    }).then(this, [this](const QList<qint64>& ids) {
+        if (ids.isEmpty())
+            return;
+        auto reply = QMessageBox::question(this, tr("Submit All Evidence"),
+                                           tr("This will submit all %1 evidence matching the current filter "
+                                              "(evidence that has already been submitted is skipped). "
+                                              "Do you want to continue?").arg(ids.size()),
+                                           QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+        if (reply == QMessageBox::Yes)
+            submitSet(ids);
+    });
+}
+
+void EvidenceManager::submitSet(const QList<qint64>& ids)
+{
+    // the uploads happen in the background; each row is updated as its upload progresses
+    uploads->enqueue(ids).then(this, [this](const DatabaseResult& queued) {
+        if (!queued.success) {
+            QMessageBox::warning(this, tr("Cannot submit evidence"),
+                                 tr("Unable to queue evidence for upload. Please try again.\n"
+                                    "(Error: %1)").arg(queued.errorText));
+        }
+    });
 }
 
 void EvidenceManager::deleteEvidenceTriggered() {
@@ -226,81 +279,58 @@ void EvidenceManager::deleteEvidenceTriggered() {
 }
 
 void EvidenceManager::deleteAllTriggered() {
-  auto reply = QMessageBox::question(this, tr("Delete All Evidence"), tr("Warning: This will delete ALL "
-                                     "evidence currently listed in this table. Do you want to continue?"),
-                                     QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
-
-  if (reply == QMessageBox::Yes) {
-    QList<qint64> ids;
-    for(int rowIndex = 0; rowIndex < evidenceTable->rowCount(); rowIndex++) {
-      ids.append(evidenceTable->item(rowIndex, 0)->data(Qt::UserRole).toLongLong());
-    }
-    deleteSet(ids);
-  }
-}
-
-/// parentDir returns the parent directory for a given file path.
-/// example: Input: path/to/file.txt Output: path/to
-static QString parentDir(QString path) {
-  auto lastSlash = path.lastIndexOf("/");
-  return path.left(lastSlash);
+  // the table only holds the pages loaded so far, so the evidence is looked up by the filter instead
+  auto filter = EvidenceFilters::parseFilter(filterTextBox->text());
+  db->runRead([filter](DatabaseConnection* conn) {
+    return conn->getEvidenceIDsWithFilters(filter);
+  }).then(this, [this](const QList<qint64>& ids) {
+    if (ids.isEmpty())
+      return;
+    auto reply = QMessageBox::question(this, tr("Delete All Evidence"),
+                                       tr("Warning: This will delete ALL %1 evidence matching the current "
+                                          "filter. Do you want to continue?").arg(ids.size()),
+                                       QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+    if (reply == QMessageBox::Yes)
+      deleteSet(ids);
+  });
 }
 
 void EvidenceManager::deleteSet(QList<qint64> ids) {
-  QList<DeleteEvidenceResponse> responses = evidenceEditor->deleteEvidence(ids);
-  QStringList undeletedFiles;
-  bool removedAllDbRecords = true;
-  QStringList paths;
-  for(const auto& response : responses) {
-    if (!response.fileDeleteSuccess) {
-      undeletedFiles << response.model.path;
-    }
-    removedAllDbRecords = removedAllDbRecords && response.dbDeleteSuccess;
-    auto parentPath = parentDir(response.model.path);
-    if (!paths.contains(parentPath)) {
-      paths << parentPath;
-    }
-  }
+  evidenceEditor->deleteEvidence(ids).then(this, [this](const DeleteEvidenceResult& result) {
+    onEvidenceDeleted(result);
+  });
+}
 
-  if (!removedAllDbRecords) {
-    qWarning() << "Could not delete evidence from internal database. Errors: ";
-    for (const auto& resp : responses) {
-      if (!resp.dbDeleteSuccess) {
-        qWarning() << "  id: " << resp.model.id << " ;; Error: "<< resp.errorText;
-      }
-    }
+void EvidenceManager::onEvidenceDeleted(const DeleteEvidenceResult& result) {
+  if (!result.dbDeleteSuccess) {
+    qWarning() << "Could not delete evidence from internal database. Error: " << result.dbErrorText;
+    QMessageBox::warning(this, tr("Could not complete evidence deletion"),
+                         tr("The selected evidence could not be deleted. No evidence was removed."));
+    return;
   }
+  loadEvidence();
+}
 
-  if (undeletedFiles.length() > 0) {
-    bool logWritten = true;
-    auto errLogPath = QStringLiteral("%1/%2.log")
-            .arg(AppConfig::value(CONFIG::EVIDENCEREPO)
-            , QDateTime::currentDateTime().toMSecsSinceEpoch());
-
-    QByteArray dataToWrite = tr("Paths to files that could not be deleted: \n\n %1")
-              .arg(undeletedFiles.join(QStringLiteral("\n"))).toUtf8();
-    logWritten = FileHelpers::writeFile(errLogPath, dataToWrite);
+void EvidenceManager::onFilesNotRemoved(const QStringList& files) {
+  auto errLogPath = QStringLiteral("%1/%2.log")
+          .arg(AppConfig::value(CONFIG::EVIDENCEREPO)
+          , QString::number(QDateTime::currentDateTime().toMSecsSinceEpoch()));
 
-    QString msg = tr("Some files could not be deleted.");
-    if (logWritten)
-        msg.append(tr(" A list of the excluded files can be found here: \n").arg(errLogPath));
+  QByteArray dataToWrite = tr("Paths to files that could not be deleted: \n\n %1")
+            .arg(files.join(QStringLiteral("\n"))).toUtf8();
+  bool logWritten = FileHelpers::writeFile(errLogPath, dataToWrite);
 
-    QMessageBox::warning(this, tr("Could not complete evidence deletion"), msg);
-  }
+  QString msg = tr("%n deleted evidence file(s) could not be removed. Removal is retried later.", "", files.size());
+  if (logWritten)
+      msg.append(tr(" A list of the files can be found here: \n%1").arg(errLogPath));
 
-  for (const auto& p : paths) {
-    auto path = QDir(p);
-    auto dirName = path.dirName();
-    path.cdUp();
-    path.rmdir(dirName);
-  }
-
-  loadEvidence();
+  QMessageBox::warning(this, tr("Could not complete evidence deletion"), msg);
 }
 
 void EvidenceManager::copyPathTriggered() {
-  auto evidence = db->getEvidenceDetails(selectedRowEvidenceID());
-  QApplication::clipboard()->setText(evidence.path);
+  db->getEvidenceDetails(selectedRowEvidenceID()).then(this, [](const model::Evidence& evidence) {
+    QApplication::clipboard()->setText(evidence.path);
+  });
 }
 
 void EvidenceManager::openTableContextMenu(QPoint pos) {
@@ -310,8 +340,9 @@ void EvidenceManager::openTableContextMenu(QPoint pos) {
   }
   bool singleItemSelected = selectedRowCount == 1;
   copyPathToClipboardAction->setEnabled(singleItemSelected);
-  bool wasSubmitted = !evidenceEditor->encodeEvidence().uploadDate.isNull();
-  submitEvidenceAction->setEnabled(singleItemSelected && !wasSubmitted);
+  // submitted evidence is skipped when queued, so any multi-row selection can be submitted
+  bool wasSubmitted = singleItemSelected && !evidenceEditor->encodeEvidence().uploadDate.isNull();
+  submitEvidenceAction->setEnabled(!wasSubmitted);
   evidenceTableContextMenu->popup(evidenceTable->viewport()->mapToGlobal(pos));
 }
 
@@ -334,22 +365,64 @@ void EvidenceManager::loadEvidence()
         reselectId = selectedRowEvidenceID();
     }
 
-    evidenceTable->clearContents();
+    loadedFilter = EvidenceFilters::parseFilter(filterTextBox->text());
+    loadEvidencePage(loadedFilter, EvidencePageKey(), ++loadGeneration, reselectId);
+}
 
-    auto filter = EvidenceFilters::parseFilter(filterTextBox->text());
-    QList<model::Evidence> operationEvidence = db->getEvidenceWithFilters(filter);
-    if(db->lastError().type() != QSqlError::NoError){
-        qWarning() << "Could not retrieve evidence for operation. Error: " << db->lastError().text();
+void EvidenceManager::loadEvidencePage(const EvidenceFilters& filter, const EvidencePageKey& after,
+                                       quint64 generation, qint64 reselectId)
+{
+    pageLoading = true;
+    db->getEvidencePage(filter, after, evidencePageSize)
+        .then(this, [this, filter, after, generation, reselectId](const EvidencePage& page) {
+        if (generation != loadGeneration)
+            return; // superseded by a newer load
+        pageLoading = false;
+        bool firstPage = !after.isValid();
+        renderEvidence(page.evidence, firstPage);
+        nextPage = page.next;
+        moreToLoad = !page.atEnd;
+        // keep looking for the previous selection in later pages until it is found
+        qint64 stillToSelect = reselectId;
+        if ((firstPage || reselectId != -1) && reselectEvidence(reselectId, firstPage))
+            stillToSelect = -1;
+        if (moreToLoad && stillToSelect != -1) {
+            loadEvidencePage(filter, page.next, generation, stillToSelect);
+            return;
+        }
+        // the scroll bar only learns of the new rows once the table is laid out
+        QTimer::singleShot(0, this, &EvidenceManager::loadMoreIfNeeded);
+    });
+}
+
+void EvidenceManager::loadMoreIfNeeded()
+{
+    if (!moreToLoad || pageLoading)
+        return;
+    auto scrollBar = evidenceTable->verticalScrollBar();
+    if (scrollBar->maximum() > 0 && scrollBar->value() < scrollBar->maximum() - scrollBar->pageStep())
+        return;
+    loadEvidencePage(loadedFilter, nextPage, loadGeneration, -1);
+}
+
+void EvidenceManager::renderEvidence(const QList<model::Evidence>& operationEvidence, bool replaceRows)
+{
+    if (replaceRows) {
+        evidenceTable->clearContents();
+        evidenceTable->setRowCount(0);
+        rowItems.clear();
     }
-    evidenceTable->setRowCount(operationEvidence.size());
+    int firstRow = evidenceTable->rowCount();
+    evidenceTable->setRowCount(firstRow + operationEvidence.size());
 
     // removing sorting temporarily to solve a bug (per qt: not a bug)
     // Essentially, _not_ doing this breaks reloading the table. Mostly empty cells appear.
     // from: https://stackoverflow.com/a/8904287/4262552
     // see also: https://bugreports.qt.io/browse/QTBUG-75479
     evidenceTable->setSortingEnabled(false);
-    for (size_t row = 0; row < operationEvidence.size(); row++) {
-        auto evi = operationEvidence.at(row);
+    for (int i = 0; i < operationEvidence.size(); i++) {
+        auto evi = operationEvidence.at(i);
+        int row = firstRow + i;
         auto rowData = buildBaseEvidenceRow(evi.id);
 
         evidenceTable->setItem(row, COL_OPERATION, rowData.operation);
@@ -361,22 +434,30 @@ void EvidenceManager::loadEvidence()
         evidenceTable->setItem(row, COL_ERROR_MSG, rowData.errorText);
         evidenceTable->setItem(row, COL_SUBMITTED, rowData.submitted);
         evidenceTable->setItem(row, COL_DATE_SUBMITTED, rowData.dateSubmitted);
+        rowItems.insert(evi.id, evidenceTable->item(row, 0));
 
         setRowText(row, evi);
     }
     evidenceTable->setSortingEnabled(true);
-    if (evidenceTable->rowCount() > 0) {
-        // try to reselect the last viewed evidence, if it's still in the list
-        int selectRow = 0;
-        for (int rowIndex = 0; rowIndex < evidenceTable->rowCount(); rowIndex++) {
-            auto evidenceID = evidenceTable->item(rowIndex, 0)->data(Qt::UserRole).toLongLong();
-            if(evidenceID == reselectId) {
-                selectRow = rowIndex;
-                break;
-            }
-        }
-        evidenceTable->setCurrentCell(selectRow, 0);
+}
+
+int EvidenceManager::rowForEvidence(qint64 evidenceID)
+{
+    auto item = rowItems.value(evidenceID);
+    return item ? item->row() : -1;
+}
+
+bool EvidenceManager::reselectEvidence(qint64 evidenceID, bool fallbackToFirst)
+{
+    // try to reselect the last viewed evidence, if it's still in the list
+    auto rowIndex = rowForEvidence(evidenceID);
+    if (rowIndex != -1) {
+        evidenceTable->setCurrentCell(rowIndex, 0);
+        return true;
     }
+    if (fallbackToFirst && evidenceTable->rowCount() > 0)
+        evidenceTable->setCurrentCell(0, 0);
+    return false;
 }
 
 // buildBaseEvidenceRow constructs a container for a row of data.
@@ -417,7 +498,7 @@ void EvidenceManager::setRowText(int row, const model::Evidence& model) {
   setColText(COL_DESCRIPTION, model.description);
   setColText(COL_OPERATION, model.operationSlug);
   setColText(COL_CONTENT_TYPE, model.contentType);
-  setColText(COL_SUBMITTED, model.uploadDate.isNull() ? QStringLiteral("No") : QStringLiteral("Yes"));
+  setColText(COL_SUBMITTED, model.uploadDate.isNull() ? uploadStatusText(model.id) : QStringLiteral("Yes"));
   setColText(COL_FAILED, model.errorText.isEmpty() ? QString() : QStringLiteral("Yes"));
   setColText(COL_PATH, QDir::toNativeSeparators(model.path));
   setColText(COL_ERROR_MSG, model.errorText);
@@ -426,29 +507,56 @@ void EvidenceManager::setRowText(int row, const model::Evidence& model) {
   setColText(COL_DATE_SUBMITTED, uploadDateText);
 }
 
+QString EvidenceManager::uploadStatusText(qint64 evidenceID) {
+  switch (uploads->uploadStatus(evidenceID)) {
+    case UploadQueue::UploadStatus::Queued:
+      return tr("Queued");
+    case UploadQueue::UploadStatus::Uploading:
+      return tr("Uploading");
+    case UploadQueue::UploadStatus::Retrying:
+      return tr("Retrying");
+    case UploadQueue::UploadStatus::NotQueued:
+      break;
+  }
+  return QStringLiteral("No");
+}
+
+void EvidenceManager::setRowUploadStatus(int row, qint64 evidenceID) {
+  auto item = evidenceTable->item(row, COL_SUBMITTED);
+  // submitted rows are refreshed from the database instead
+  if (item && item->text() != QStringLiteral("Yes"))
+    item->setText(uploadStatusText(evidenceID));
+}
+
 void EvidenceManager::refreshRow(int row)
 {
-    auto evidenceID = selectedRowEvidenceID();
-    auto updatedData = db->getEvidenceDetails(evidenceID);
-    if (updatedData.id != -1) {
-        setRowText(row, updatedData);
-        return;
-    }
-    qWarning() << "Could not refresh table row: " << db->errorString();
+    auto evidenceID = evidenceTable->item(row, 0)->data(Qt::UserRole).toLongLong();
+    db->getEvidenceDetails(evidenceID).then(this, [this, row, evidenceID](const model::Evidence& updatedData) {
+        if (updatedData.id == -1) {
+            qWarning() << "Could not refresh table row for evidence" << evidenceID;
+            return;
+        }
+        // the table may have been reloaded or resorted while the data was loading
+        auto rowItem = evidenceTable->item(row, 0);
+        if (rowItem && rowItem->data(Qt::UserRole).toLongLong() == evidenceID)
+            setRowText(row, updatedData);
+    });
 }
 
-bool EvidenceManager::saveData() {
-  auto saveResponse = evidenceEditor->saveEvidence();
-  if (saveResponse.actionSucceeded) {
-    refreshRow(evidenceTable->currentRow());
-    return true;
-  }
+QFuture<bool> EvidenceManager::saveData() {
+  auto row = evidenceTable->currentRow();
+  return evidenceEditor->saveEvidence().then(this, [this, row](const SaveEvidenceResponse& saveResponse) {
+    if (saveResponse.actionSucceeded) {
+      refreshRow(row);
+      return true;
+    }
 
-  QMessageBox::warning(this, tr("Cannot Save"),
-                       tr("Unable to save evidence data.\n"
-                       "You can try uploading directly to the website. File Location:\n%1")
-                        .arg(saveResponse.model.path));
-  return false;
+    QMessageBox::warning(this, tr("Cannot Save"),
+                         tr("Unable to save evidence data.\n"
+                         "You can try uploading directly to the website. File Location:\n%1")
+                          .arg(saveResponse.model.path));
+    return false;
+  });
 }
 
 void EvidenceManager::openFiltersMenu() {
@@ -470,47 +578,102 @@ void EvidenceManager::onRowChanged(int currentRow, int _currentColumn, int _prev
     return;
   }
 
-  auto evidence = db->getEvidenceDetails(selectedRowEvidenceID());
+  auto evidenceID = selectedRowEvidenceID();
+  db->getEvidenceDetails(evidenceID).then(this, [this, evidenceID](const model::Evidence& evidence) {
+    auto current = evidenceTable->currentItem();
+    if (!current || current->data(Qt::UserRole).toLongLong() != evidenceID)
+      return; // selection moved on while loading
 
-  auto readonly = evidence.uploadDate.isValid();
-  submitEvidenceAction->setEnabled(!readonly);
-  Q_EMIT evidenceChanged(evidence.id, true);
+    auto readonly = evidence.uploadDate.isValid();
+    submitEvidenceAction->setEnabled(!readonly);
+    Q_EMIT evidenceChanged(evidence.id, true);
 
-  int selectedRowCount = evidenceTable->selectionModel()->selectedRows().count();
-  if (selectedRowCount > 1) {
-    editButton->setEnabled(false);
-    editButton->setToolTip(tr("Only one evidence item may be edited at once."));
-  }
-  else {
-    this->editButton->setEnabled(!readonly);
-    this->editButton->setToolTip(readonly
-                                     ? tr("Edit is only available on unsubmitted evidence")
-                                     : tr("Update this data before submitting"));
+    int selectedRowCount = evidenceTable->selectionModel()->selectedRows().count();
+    if (selectedRowCount > 1) {
+      editButton->setEnabled(false);
+      editButton->setToolTip(tr("Only one evidence item may be edited at once."));
+    }
+    else {
+      this->editButton->setEnabled(!readonly);
+      this->editButton->setToolTip(readonly
+                                       ? tr("Edit is only available on unsubmitted evidence")
+                                       : tr("Update this data before submitting"));
+    }
+  });
+}
+
+void EvidenceManager::onUploadsQueued(const QList<qint64>& evidenceIDs) {
+  // queuing clears any previous upload error, so each row is refreshed in full
+  for (qint64 id : evidenceIDs) {
+    auto row = rowForEvidence(id);
+    if (row != -1)
+      refreshRow(row);
   }
+  updateUploadStats();
 }
 
-void EvidenceManager::onUploadComplete() {
-  bool isValid;
-  NetMan::extractResponse(uploadAssetReply, isValid);
+void EvidenceManager::onUploadStarted(qint64 evidenceID) {
+  auto row = rowForEvidence(evidenceID);
+  if (row != -1)
+    setRowUploadStatus(row, evidenceID);
+  updateUploadStats();
+}
 
-  if (!isValid) {
-    auto errMessage = tr("Unable to upload evidence: Network error (%1)").arg(uploadAssetReply->errorString());
-    db->updateEvidenceError(errMessage, evidenceIDForRequest);
-    QMessageBox::warning(this, tr("Cannot Submit Evidence"),
-                         tr("Upload failed: Network error. Check your connection and try again.\n"
-                         "(Error: %1)").arg(uploadAssetReply->errorString()));
-  } else {
-    db->updateEvidenceSubmitted(evidenceIDForRequest);
-    Q_EMIT evidenceChanged(evidenceIDForRequest, true);  // lock the editing form
-  }
-  refreshRow(evidenceTable->currentRow());
+void EvidenceManager::onUploadSucceeded(qint64 evidenceID) {
+  updateUploadStats();
+  auto row = rowForEvidence(evidenceID);
+  if (row == -1)
+    return;
+  refreshRow(row);
+  if (row == evidenceTable->currentRow())
+    Q_EMIT evidenceChanged(evidenceID, true);  // lock the editing form
+}
 
-  // we don't actually need anything from the uploadAssets reply, so just clean it up.
-  // one thing we might want to record: evidence uuid... not sure why we'd need it though.
-  loadingAnimation->stopAnimation();
-  evidenceTable->setEnabled(true);
+void EvidenceManager::onUploadFailed(qint64 evidenceID, const QString& error, bool willRetry) {
+  Q_UNUSED(error);
+  updateUploadStats();
+  auto row = rowForEvidence(evidenceID);
+  if (row == -1)
+    return;
+  // retries are not recorded on the evidence, so only the status changes until the last one
+  if (willRetry)
+    setRowUploadStatus(row, evidenceID);
+  else
+    refreshRow(row);
+}
+
+void EvidenceManager::updateUploadStats() {
+  auto stats = uploads->runStats();
+  if (stats.total == 0) {
+    uploadStatusLabel->clear();
+    loadingAnimation->stopAnimation();
+    uploadStatsTimer->stop();
+    return;
+  }
 
-  cleanUpReply(&uploadAssetReply);
+  auto rate = locale().formattedDataSize(stats.bytesPerSecond());
+  if (stats.finished) {
+    uploadStatusLabel->setText(tr("Submitted %1 of %2 evidence (%3 failed) in %4s, averaging %5/s")
+                                   .arg(stats.succeeded).arg(stats.total).arg(stats.failed)
+                                   .arg(stats.elapsedMs / 1000).arg(rate));
+    loadingAnimation->stopAnimation();
+    uploadStatsTimer->stop();
+    return;
+  }
+  if (!ConnectivityMonitor::get()->isOnline()) {
+    // nothing moves until the server is back; the queue drains by itself then
+    uploadStatusLabel->setText(tr("Working offline: %1 of %2 evidence waiting for the server")
+                                   .arg(stats.total - stats.succeeded - stats.failed).arg(stats.total));
+    loadingAnimation->stopAnimation();
+    uploadStatsTimer->stop();
+    return;
+  }
+  uploadStatusLabel->setText(tr("Submitting evidence: %1 of %2 done (%3 failed), %4 uploading, %5/s")
+                                 .arg(stats.succeeded + stats.failed).arg(stats.total).arg(stats.failed)
+                                 .arg(stats.uploading).arg(rate));
+  loadingAnimation->startAnimation();
+  if (!uploadStatsTimer->isActive())
+    uploadStatsTimer->start();
 }
 
 qint64 EvidenceManager::selectedRowEvidenceID() {
@@ -6,17 +6,23 @@
 #include "ashirtdialog/ashirtdialog.h"
 
 #include <QAction>
+#include <QFuture>
+#include <QHash>
+#include <QLabel>
 #include <QLineEdit>
 #include <QMenu>
-#include <QNetworkReply>
 #include <QTableWidget>
 #include <QTableWidgetItem>
+#include <QTimer>
 
 #include "components/evidence_editor/evidenceeditor.h"
 #include "components/loading/qprogressindicator.h"
-#include "db/databaseconnection.h"
+#include "db/databaseworker.h"
 #include "forms/evidence_filter/evidencefilterform.h"
 
+class EvidenceCollector;
+class UploadQueue;
+
 //class
 /// EvidenceRow contains the necessary data for a full row in the evidence table.
 /// QTableWidget should memory-manage this data.
@@ -40,8 +46,8 @@ class EvidenceManager : public AShirtDialog {
   Q_OBJECT
 
  public:
-  explicit EvidenceManager(DatabaseConnection* db, QWidget* parent = nullptr);
-  ~EvidenceManager();
+  explicit EvidenceManager(DatabaseWorker* db, UploadQueue* uploads, EvidenceCollector* collector,
+                           QWidget* parent = nullptr);
 
  private:
   /// buildUi constructs the window structure.
@@ -54,16 +60,41 @@ class EvidenceManager : public AShirtDialog {
   /// openTableContextMenu opens a context menu over the evidenceTable when right-clicking
   void openTableContextMenu(QPoint pos);
 
-  /// saveData stores any edits in evidence view. Deprecated (edits no longer available)
-  bool saveData();
-  /// loadEvidence retrieves data from the database and renders the evidence table
+  /// saveData stores any edits in evidence view. Resolves to true if the save succeeded.
+  /// Deprecated (edits no longer available)
+  QFuture<bool> saveData();
+  /// loadEvidence retrieves data from the database (in the background, a page at a time) and
+  /// renders the evidence table. Only the first page is loaded up front; see loadMoreIfNeeded.
   void loadEvidence();
+  /// loadEvidencePage requests the page of evidence following after, and appends it to the table.
+  /// Pages keep loading while reselectId has not been found, unless a newer load has started.
+  void loadEvidencePage(const EvidenceFilters& filter, const EvidencePageKey& after,
+                        quint64 generation, qint64 reselectId);
+  /// loadMoreIfNeeded loads the next page once the table is scrolled to (or does not fill) its end
+  void loadMoreIfNeeded();
+  /// renderEvidence adds the provided evidence to the table, replacing the current rows if
+  /// replaceRows is true
+  void renderEvidence(const QList<model::Evidence>& operationEvidence, bool replaceRows);
+  /// reselectEvidence selects the row for evidenceID. If it is not present, the first row is
+  /// selected when fallbackToFirst is set. Returns true if the evidence was found.
+  bool reselectEvidence(qint64 evidenceID, bool fallbackToFirst);
   /// buildBaseEvidenceRow constructs a basic evidence row (fields and formatting, no data applied)
   EvidenceRow buildBaseEvidenceRow(qint64 evidenceID);
   /// refreshRow updates the indicated row (0-based) with updated (database) data.
+  /// The row is only updated if it still holds the same evidence once the data arrives.
   void refreshRow(int row);
+  /// rowForEvidence returns the row (0-based) showing evidenceID, or -1 if it is not in the table.
+  /// Looked up through rowItems, so it does not walk the table.
+  int rowForEvidence(qint64 evidenceID);
   /// setRowText writes data the indicated row (0-based) based on the given model
   void setRowText(int row, const model::Evidence& model);
+  /// setRowUploadStatus shows where the evidence on the indicated row (0-based) is in the upload queue.
+  /// Only unsubmitted evidence is updated.
+  void setRowUploadStatus(int row, qint64 evidenceID);
+  /// uploadStatusText describes where the evidence is in the upload queue ("No" if not queued)
+  QString uploadStatusText(qint64 evidenceID);
+  /// submitSet queues the provided ids for upload
+  void submitSet(const QList<qint64>& ids);
 
   /// showEvent extends QDialog's showEvent. Resets the applied filters.
   void showEvent(QShowEvent* evt) override;
@@ -83,6 +114,9 @@ class EvidenceManager : public AShirtDialog {
  private slots:
   /// submitEvidenceTriggered recieves the triggered event from the submit action
   void submitEvidenceTriggered();
+  /// submitAllTriggered recieves the triggered event from the submit all action; submits every
+  /// evidence matching the current filter
+  void submitAllTriggered();
   /// deleteEvidenceTriggered recieves the triggered event from the delete action
   void deleteEvidenceTriggered();
   /// resetFilterButtonClicked recieves the reset filter button clicked event
@@ -97,9 +131,13 @@ class EvidenceManager : public AShirtDialog {
   /// cancelEditEvidenceButtonClicked resets the edit/cancel buttons
   void cancelEditEvidenceButtonClicked();
 
-  /// deleteSet is a small helper to iterate through the provided list, delete the ids, and process
-  /// the result
+  /// deleteSet deletes the provided ids in the background, then processes the result
   void deleteSet(QList<qint64> ids);
+  /// onEvidenceDeleted reports any failure from deleteSet, or reloads the evidence table
+  void onEvidenceDeleted(const DeleteEvidenceResult& result);
+  /// onFilesNotRemoved tells the user which deleted evidence files could not be removed, also
+  /// writing the list to a log in the evidence repository
+  void onFilesNotRemoved(const QStringList& files);
 
   /// applyFilterForm updates the filter textbox to reflect the filter options chosen in the filter
   /// menu
@@ -109,18 +147,41 @@ class EvidenceManager : public AShirtDialog {
 
   /// onRowChanged recieves the event from the evidence table rowChange signal
   void onRowChanged(int currentRow, int currentColumn, int previousRow, int previousColumn);
-  /// onUploadComplete is triggered when the upload response has been received.
-  void onUploadComplete();
+  /// onUploadsQueued shows the newly queued status on each row
+  void onUploadsQueued(const QList<qint64>& evidenceIDs);
+  /// onUploadStarted shows the uploading status on the evidence's row
+  void onUploadStarted(qint64 evidenceID);
+  /// onUploadSucceeded refreshes the uploaded evidence's row, locking the editor if it is selected
+  void onUploadSucceeded(qint64 evidenceID);
+  /// onUploadFailed shows the retrying status, or refreshes the evidence's row once the upload has
+  /// failed for good
+  void onUploadFailed(qint64 evidenceID, const QString& error, bool willRetry);
+  /// updateUploadStats shows the progress and throughput of the upload queue's current run
+  void updateUploadStats();
 
   /// copyPathTriggered recives the triggered event from the copyPathToClipboardAction
   void copyPathTriggered();
 
  private:
   /// db is a (shared) reference to the local database instance. Not to be deleted.
-  DatabaseConnection* db;
-
-  QNetworkReply* uploadAssetReply = nullptr;
-  qint64 evidenceIDForRequest = 0;
+  DatabaseWorker* db;
+  /// uploads is the (shared) background upload queue. Not to be deleted.
+  UploadQueue* uploads;
+  /// collector removes the files of deleted evidence. Not to be deleted.
+  EvidenceCollector* collector;
+
+  /// loadGeneration identifies the most recent loadEvidence call; pages from older loads are dropped
+  quint64 loadGeneration = 0;
+  /// loadedFilter and nextPage pick up the current load where its last page left off
+  EvidenceFilters loadedFilter;
+  EvidencePageKey nextPage;
+  bool moreToLoad = false;
+  bool pageLoading = false;
+  /// rowItems maps each evidence id in the table to the first item of its row. Items follow their
+  /// row when the table is sorted, so item->row() is always current.
+  QHash<qint64, QTableWidgetItem*> rowItems;
+  inline static const int evidencePageSize = 250;
+  inline static const int uploadStatsIntervalMs = 500;
 
   // Subwindows
   EvidenceFilterForm* filterForm = nullptr;
@@ -140,6 +201,8 @@ class EvidenceManager : public AShirtDialog {
   QTableWidget* evidenceTable = nullptr;
   EvidenceEditor* evidenceEditor = nullptr;
   QProgressIndicator* loadingAnimation = nullptr;
+  QLabel* uploadStatusLabel = nullptr;
+  QTimer* uploadStatsTimer = nullptr;
   inline static const QStringList columnNames {
       QStringLiteral("Date Captured")
       , QStringLiteral("Operation")
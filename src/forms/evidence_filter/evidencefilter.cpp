@@ -25,6 +25,9 @@ QString EvidenceFilters::standardizeFilterKey(QString key) {
   if (FILTER_KEYS_CONTENT_TYPE.contains(key, Qt::CaseInsensitive)) {
     return FILTER_KEY_CONTENT_TYPE;
   }
+  if (FILTER_KEYS_TEXT.contains(key, Qt::CaseInsensitive)) {
+    return FILTER_KEY_TEXT;
+  }
   return key;
 }
 
@@ -74,6 +77,9 @@ QString EvidenceFilters::toString() const {
   if (submitted != Any) {
     rtn.append(appendTemp.arg(FILTER_KEY_SUBMITTED, triToText(submitted)));
   }
+  if (!searchText.isEmpty()) {
+    rtn.append(appendTemp.arg(FILTER_KEY_TEXT, searchText));
+  }
 
   return rtn.trimmed();
 }
@@ -115,6 +121,9 @@ EvidenceFilters EvidenceFilters::parseFilter(const QString& text) {
     else if (key == FILTER_KEY_CONTENT_TYPE) {
       filter.contentType = value;
     }
+    else if (key == FILTER_KEY_TEXT) {
+      filter.searchText = value;
+    }
   }
 
   return filter;
@@ -23,6 +23,8 @@ class EvidenceFilters {
   Tri submitted = Any;
   QDate startDate = QDate();
   QDate endDate = QDate();
+  /// searchText is matched against the full text of the evidence description and codeblock content
+  QString searchText;
 
  public:
   static Tri parseTri(const QString &text);
@@ -41,6 +43,7 @@ class EvidenceFilters {
   inline static const QString FILTER_KEY_ON = QStringLiteral("on");
   inline static const QString FILTER_KEY_OPERATION = QStringLiteral("op");
   inline static const QString FILTER_KEY_CONTENT_TYPE = QStringLiteral("type");
+  inline static const QString FILTER_KEY_TEXT = QStringLiteral("text");
 
   // These represent aliases for standard key for a filter
   inline static const QStringList FILTER_KEYS_ERROR = {
@@ -56,4 +59,8 @@ class EvidenceFilters {
   inline static const QStringList FILTER_KEYS_ON = {FILTER_KEY_ON};
   inline static const QStringList FILTER_KEYS_OPERATION = {FILTER_KEY_OPERATION, QStringLiteral("operation")};
   inline static const QStringList FILTER_KEYS_CONTENT_TYPE = {FILTER_KEY_CONTENT_TYPE, QStringLiteral("contentType")};
+  inline static const QStringList FILTER_KEYS_TEXT = {
+      FILTER_KEY_TEXT, QStringLiteral("search")
+      , QStringLiteral("contains")
+  };
 };
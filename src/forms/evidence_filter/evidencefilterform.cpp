@@ -9,6 +9,7 @@
 #include <QDialogButtonBox>
 #include <QGridLayout>
 #include <QLabel>
+#include <QLineEdit>
 
 #include "appconfig.h"
 #include "helpers/netman.h"
@@ -48,6 +49,7 @@ EvidenceFilterForm::EvidenceFilterForm(QWidget *parent)
     , toDateEdit(new QDateEdit(this))
     , includeStartDateCheckBox(new QCheckBox(tr("From Date"), this))
     , includeEndDateCheckBox(new QCheckBox(tr("To Date"), this))
+    , searchTextBox(new QLineEdit(this))
     , buttonBox(new QDialogButtonBox(QDialogButtonBox::Ok, this))
 {
   buildUi();
@@ -72,6 +74,9 @@ void EvidenceFilterForm::buildUi() {
   initializeDateEdit(fromDateEdit);
   initializeDateEdit(toDateEdit);
 
+  searchTextBox->setClearButtonEnabled(true);
+  searchTextBox->setPlaceholderText(tr("Description or codeblock text"));
+
   // Layout
   /*        0                 1           2
        +---------------+-------------+--------------+
@@ -87,7 +92,9 @@ void EvidenceFilterForm::buildUi() {
        +---------------+-------------+--------------+
     5  | To Lbl        | To DtSel    | incl To CB   |
        +---------------+-------------+--------------+
-    6  | Dialog button Box{ok}                      |
+    6  | Search Lbl    | Search TB                  |
+       +---------------+-------------+--------------+
+    7  | Dialog button Box{ok}                      |
        +---------------+-------------+--------------+
   */
 
@@ -110,11 +117,14 @@ void EvidenceFilterForm::buildUi() {
   gridLayout->addWidget(includeEndDateCheckBox, 5, 0, Qt::AlignLeft);
   gridLayout->addWidget(toDateEdit, 5, 1, 1, 2);
 
-  gridLayout->addWidget(buttonBox, 6, 0, 1, gridLayout->columnCount());
+  gridLayout->addWidget(new QLabel(tr("Contains Text"), this), 6, 0);
+  gridLayout->addWidget(searchTextBox, 6, 1, 1, 2);
+
+  gridLayout->addWidget(buttonBox, 7, 0, 1, gridLayout->columnCount());
 
   setLayout(gridLayout);
   setWindowTitle(tr("Evidence Filters"));
-  resize(320, 245);
+  resize(320, 275);
 }
 
 void EvidenceFilterForm::wireUi() {
@@ -156,6 +166,8 @@ EvidenceFilters EvidenceFilterForm::encodeForm() {
   if (includeEndDateCheckBox->isChecked()) {
     filter.endDate = toDateEdit->date();
   }
+  // ':' separates keys from values in the filter text, so it cannot be part of a value
+  filter.searchText = searchTextBox->text().remove(QLatin1Char(':')).simplified();
 
   return filter;
 }
@@ -175,6 +187,7 @@ void EvidenceFilterForm::setForm(const EvidenceFilters &model) {
                                                   : QDateTime::currentDateTime().date());
 
   dateNormalize(model.startDate.isValid() && model.endDate.isValid());
+  searchTextBox->setText(model.searchText);
 }
 
 void EvidenceFilterForm::onOperationListUpdated(bool success,
@@ -13,6 +13,7 @@ class QLabel;
 class QDateEdit;
 class QCheckBox;
 class QDialogButtonBox;
+class QLineEdit;
 
 class EvidenceFilterForm : public AShirtDialog {
   Q_OBJECT
@@ -56,6 +57,7 @@ class EvidenceFilterForm : public AShirtDialog {
   QDateEdit* toDateEdit = nullptr;
   QCheckBox* includeEndDateCheckBox = nullptr;
   QCheckBox* includeStartDateCheckBox = nullptr;
+  QLineEdit* searchTextBox = nullptr;
   QDialogButtonBox* buttonBox = nullptr;
   void initializeTriCombobox(QComboBox *box);
   void initializeDateEdit(QDateEdit *dateEdit);
@@ -8,13 +8,13 @@
 
 #include "components/evidence_editor/evidenceeditor.h"
 #include "components/loading_button/loadingbutton.h"
-#include "db/databaseconnection.h"
-#include "helpers/netman.h"
-#include "helpers/cleanupreply.h"
+#include "components/upload_queue/uploadqueue.h"
+#include "db/databaseworker.h"
 
-GetInfo::GetInfo(DatabaseConnection* db, qint64 evidenceID, QWidget* parent)
+GetInfo::GetInfo(DatabaseWorker* db, UploadQueue* uploads, qint64 evidenceID, QWidget* parent)
     : AShirtDialog(parent, AShirtDialog::commonWindowFlags)
     , db(db)
+    , uploads(uploads)
     , evidenceID(evidenceID)
     , submitButton(new LoadingButton(tr("Submit"), this))
     , evidenceEditor(new EvidenceEditor(this->evidenceID, this->db, this))
@@ -25,7 +25,6 @@ GetInfo::GetInfo(DatabaseConnection* db, qint64 evidenceID, QWidget* parent)
 
 GetInfo::~GetInfo() {
   delete evidenceEditor;
-  cleanUpReply(&uploadAssetReply);
 }
 
 void GetInfo::buildUi() {
@@ -73,31 +72,45 @@ void GetInfo::showEvent(QShowEvent* evt) {
                // closing the window
 }
 
-bool GetInfo::saveData() {
-  auto saveResponse = evidenceEditor->saveEvidence();
-  if (!saveResponse.actionSucceeded) {
-    QMessageBox::warning(this, tr("Cannot Save"),
-                         tr("Unable to save evidence data.\n"
-                         "You can try uploading directly to the website. File Location:\n%1")
-                           .arg(saveResponse.model.path));
-  }
-  return saveResponse.actionSucceeded;
+QFuture<bool> GetInfo::saveData() {
+  return evidenceEditor->saveEvidence().then(this, [this](const SaveEvidenceResponse& saveResponse) {
+    if (!saveResponse.actionSucceeded) {
+      QMessageBox::warning(this, tr("Cannot Save"),
+                           tr("Unable to save evidence data.\n"
+                           "You can try uploading directly to the website. File Location:\n%1")
+                             .arg(saveResponse.model.path));
+    }
+    return saveResponse.actionSucceeded;
+  });
 }
 
 void GetInfo::submitButtonClicked()
 {
     submitButton->startAnimation();
     Q_EMIT setActionButtonsEnabled(false);
-    if (!saveData())
-        return;
-    model::Evidence evi = db->getEvidenceDetails(evidenceID);
-    if(evi.id == -1) {
-        QMessageBox::warning(this, tr("Cannot submit evidence"),
-                             tr("Could not retrieve data. Please try again."));
-        return;
-    }
-    uploadAssetReply = NetMan::uploadAsset(evi);
-    connect(uploadAssetReply, &QNetworkReply::finished, this, &GetInfo::onUploadComplete);
+    saveData().then(this, [this](bool saved) {
+        if (!saved) {
+            submitButton->stopAnimation();
+            Q_EMIT setActionButtonsEnabled(true);
+            return;
+        }
+        // the upload happens in the background (and is retried as needed), so there is no need to
+        // keep this window open for it
+        uploads->enqueue({evidenceID}).then(this, [this](const DatabaseResult& queued) {
+            if (!queued.success) {
+                submitButton->stopAnimation();
+                Q_EMIT setActionButtonsEnabled(true);
+                QMessageBox::warning(this, tr("Cannot submit evidence"),
+                                     tr("Unable to queue evidence for upload. Please try again.\n"
+                                        "(Error: %1)").arg(queued.errorText));
+                return;
+            }
+            db->getEvidenceDetails(evidenceID).then(this, [this](const model::Evidence& evi) {
+                Q_EMIT evidenceSubmitted(evi);
+                close();
+            });
+        });
+    });
 }
 
 void GetInfo::deleteButtonClicked() {
@@ -107,48 +120,15 @@ void GetInfo::deleteButtonClicked() {
 
   if (reply == QMessageBox::Yes) {
     Q_EMIT  setActionButtonsEnabled(false);
-    bool shouldClose = true;
-
-    model::Evidence evi = evidenceEditor->encodeEvidence();
-    if (!QFile::remove(evi.path)) {
-      QMessageBox::warning(this, tr("Could not delete"),
-                           tr("Unable to delete evidence file.\n"
-                           "You can try deleting the file directly. File Location:\n%1")
-                             .arg(evi.path));
-      shouldClose = false;
-    }
-
-    db->deleteEvidence(evidenceID);
-
-    Q_EMIT setActionButtonsEnabled(true);
-    if (shouldClose) {
+    // the file is removed later, along with the record, by the EvidenceCollector
+    db->deleteEvidence(evidenceID).then(this, [this](const DatabaseResult& deleted) {
+      Q_EMIT setActionButtonsEnabled(true);
+      if (!deleted.success) {
+        QMessageBox::warning(this, tr("Could not delete"),
+                             tr("Unable to delete evidence. Error: %1").arg(deleted.errorText));
+        return;
+      }
       close();
-    }
+    });
   }
 }
-
-void GetInfo::onUploadComplete()
-{
-    if (uploadAssetReply->error() != QNetworkReply::NoError) {
-        auto errMessage = tr("Unable to upload evidence: Network error (%1)").arg(uploadAssetReply->errorString());
-        db->updateEvidenceError(errMessage, evidenceID);
-        if(!db->errorString().isEmpty())
-            qWarning() << "Upload failed. Could not update internal database. Error: " << db->errorString();
-        QMessageBox::warning(this, tr("Cannot submit evidence"),
-                             tr("Upload failed: Network error. Check your connection and try again.\n"
-                                "Note: This evidence has been saved. You can close this window and "
-                                "re-submit from the evidence manager."
-                                "\n(Error: %1)").arg(uploadAssetReply->errorString()));
-    } else {
-        db->updateEvidenceSubmitted(evidenceID);
-        if(!db->errorString().isEmpty())
-            qWarning() << "Upload successful. Could not update internal database. Error: " << db->errorString();
-        Q_EMIT evidenceSubmitted(db->getEvidenceDetails(evidenceID));
-        close();
-    }
-    // we don't actually need anything from the uploadAssets reply, so just clean it up.
-    // one thing we might want to record: evidence uuid... not sure why we'd need it though.
-    submitButton->stopAnimation();
-    Q_EMIT setActionButtonsEnabled(true);
-    cleanUpReply(&uploadAssetReply);
-}
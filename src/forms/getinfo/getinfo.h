@@ -5,23 +5,25 @@
 
 #include "ashirtdialog/ashirtdialog.h"
 
-#include <QNetworkReply>
+#include <QFuture>
 #include "components/evidence_editor/evidenceeditor.h"
 
-class DatabaseConnection;
+class DatabaseWorker;
 class LoadingButton;
+class UploadQueue;
 
 class GetInfo : public AShirtDialog {
   Q_OBJECT
 
  public:
-  explicit GetInfo(DatabaseConnection *db, qint64 evidenceID, QWidget *parent = nullptr);
+  explicit GetInfo(DatabaseWorker *db, UploadQueue *uploads, qint64 evidenceID, QWidget *parent = nullptr);
   ~GetInfo();
 
  private:
   void buildUi();
   void wireUi();
-  bool saveData();
+  /// saveData stores the editor content. Resolves to true if the save succeeded.
+  QFuture<bool> saveData();
   void showEvent(QShowEvent *evt) override;
 
  signals:
@@ -29,16 +31,16 @@ class GetInfo : public AShirtDialog {
  private slots:
   void submitButtonClicked();
   void deleteButtonClicked();
-  void onUploadComplete();
 
  public:
  signals:
+  /// evidenceSubmitted is emitted once the evidence has been saved and queued for upload
   void evidenceSubmitted(model::Evidence evidence);
 
  private:
-  DatabaseConnection *db;
+  DatabaseWorker *db;
+  UploadQueue *uploads;
   qint64 evidenceID;
-  QNetworkReply *uploadAssetReply = nullptr;
 
   // Ui Components
   EvidenceEditor *evidenceEditor = nullptr;
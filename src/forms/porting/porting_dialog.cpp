@@ -11,9 +11,9 @@
 #include <QPushButton>
 #include <QtConcurrent/QtConcurrent>
 
-#include "db/databaseconnection.h"
+#include "db/databaseworker.h"
 
-PortingDialog::PortingDialog(PortType dialogType, DatabaseConnection* db, QWidget *parent)
+PortingDialog::PortingDialog(PortType dialogType, DatabaseWorker* db, QWidget *parent)
   : AShirtDialog(parent)
   , dialogType(dialogType)
   , db(db)
@@ -162,18 +162,22 @@ void PortingDialog::doExport(porting::SystemManifest* manifest, const QString& e
     options.exportConfig = portConfigCheckBox->isChecked();
     
     // Qt db access is limited to single-thread access. A new connection needs to be made, hence
-    // the withconnection here that connects to the same database. Note: we shouldn't write to the db
-    // in this thread, if possible.
+    // the withconnection here that connects to the same database. The export only reads, so the
+    // connection is read-only, and (under WAL) does not hold up captures while it runs.
     QString threadedDbName = QStringLiteral("%1_mt_forExport").arg(Constants::defaultDbName);
-    auto success = DatabaseConnection::withConnection(
-                db->getDatabasePath(), threadedDbName, [this, &manifest, exportPath, options](DatabaseConnection conn) {
+    QString errorText;
+    auto success = DatabaseConnection::withReadOnlyConnection(
+                db->databasePath(), threadedDbName, [this, &manifest, exportPath, options, &errorText](DatabaseConnection conn) {
                                           manifest->exportManifest(&conn, exportPath, options);
+                                          errorText = conn.errorString();
     });
     if(success) {
         Q_EMIT onWorkComplete(true);
         return;
     }
-    portStatusLabel->setText(tr("Error during export: %1").arg(db->errorString()));
+    if (errorText.isEmpty())
+        errorText = tr("Unable to open the evidence database");
+    portStatusLabel->setText(tr("Error during export: %1").arg(errorText));
     Q_EMIT onWorkComplete(false);
 }
 
@@ -193,14 +197,20 @@ void PortingDialog::doImport(porting::SystemManifest* manifest)
     options.importDb = portEvidenceCheckBox->isChecked() ? options.Merge : options.None;
     options.importConfig = portConfigCheckBox->isChecked();
     QString threadedDbName = QStringLiteral("%1_mt_forImport").arg(Constants::defaultDbName);
+    bool imported = false;
+    QString errorText;
     auto success = DatabaseConnection::withConnection(
-                db->getDatabasePath(), threadedDbName, [this, &manifest, options](DatabaseConnection conn){
-        manifest->applyManifest(options, &conn);
+                db->databasePath(), threadedDbName, [&manifest, options, &imported, &errorText](DatabaseConnection conn){
+        imported = manifest->applyManifest(options, &conn);
+        errorText = conn.errorString();
     });
     if(success) {
-        Q_EMIT onWorkComplete(true);
+        // a partial import has already reported how far it got
+        Q_EMIT onWorkComplete(imported);
         return;
     }
-    portStatusLabel->setText(tr("Error during import: %1").arg(db->errorString()));
+    if (errorText.isEmpty())
+        errorText = tr("Unable to open the evidence database");
+    portStatusLabel->setText(tr("Error during import: %1").arg(errorText));
     Q_EMIT onWorkComplete(false);
 }
@@ -3,7 +3,7 @@
 #include "ashirtdialog/ashirtdialog.h"
 #include "porting/system_manifest.h"
 
-class DatabaseConnection;
+class DatabaseWorker;
 class QCheckBox;
 class QLabel;
 class QLineEdit;
@@ -34,7 +34,7 @@ class PortingDialog : public AShirtDialog {
    * @param db is a reference to the standard, running database.
    * @param parent is used by the underlying QDialog constructor
    */
-  explicit PortingDialog(PortType dialogType, DatabaseConnection* db, QWidget *parent = nullptr);
+  explicit PortingDialog(PortType dialogType, DatabaseWorker* db, QWidget *parent = nullptr);
   ~PortingDialog() = default;
 
  public:
@@ -79,7 +79,7 @@ class PortingDialog : public AShirtDialog {
   PortType dialogType;
   bool portDone = false;
 
-  DatabaseConnection* db; // borrowed
+  DatabaseWorker* db; // borrowed
 
   /// executedManifest contains a pointer to the system manifest used to import/export data
   /// Saved so that it can be cleaned up post-execution
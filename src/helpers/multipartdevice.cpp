@@ -0,0 +1,98 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#include "multipartdevice.h"
+
+#include <algorithm>
+#include <cstring>
+
+MultipartDevice::MultipartDevice(QObject *parent)
+  : QIODevice(parent)
+{ }
+
+void MultipartDevice::addData(const QByteArray &data)
+{
+  Part part;
+  part.data = data;
+  part.size = data.size();
+  _hash.addData(data);
+  appendPart(part);
+}
+
+bool MultipartDevice::addFile(const QString &path)
+{
+  auto file = new QFile(path, this);
+  if (!file->open(QIODevice::ReadOnly)) {
+    setErrorString(file->errorString());
+    delete file;
+    return false;
+  }
+  // the file is hashed as it is added; streaming it later only needs to seek back to the start
+  if (!_hash.addData(file) || !file->seek(0)) {
+    setErrorString(file->errorString());
+    delete file;
+    return false;
+  }
+  Part part;
+  part.file = file;
+  part.size = file->size();
+  appendPart(part);
+  return true;
+}
+
+void MultipartDevice::appendPart(Part part)
+{
+  part.start = _size;
+  _size += part.size;
+  _parts.append(part);
+}
+
+bool MultipartDevice::open(OpenMode mode)
+{
+  if ((mode & QIODevice::WriteOnly) || !QIODevice::open(mode | QIODevice::Unbuffered))
+    return false;
+  _pos = 0;
+  return true;
+}
+
+bool MultipartDevice::seek(qint64 pos)
+{
+  if (pos < 0 || pos > _size || !QIODevice::seek(pos))
+    return false;
+  _pos = pos;
+  return true;
+}
+
+qint64 MultipartDevice::readData(char *data, qint64 maxSize)
+{
+  qint64 total = 0;
+  for (const auto &part : _parts) {
+    if (total == maxSize || _pos >= _size)
+      break;
+    if (_pos >= part.start + part.size)
+      continue;
+    qint64 offset = _pos - part.start;
+    qint64 chunk = std::min(maxSize - total, part.size - offset);
+    if (part.file) {
+      if (part.file->pos() != offset && !part.file->seek(offset)) {
+        setErrorString(part.file->errorString());
+        return total > 0 ? total : -1;
+      }
+      chunk = part.file->read(data + total, chunk);
+      // the file shrank (or failed) after it was added; the stream cannot be completed
+      if (chunk <= 0) {
+        setErrorString(tr("Unable to read %1: %2").arg(part.file->fileName(), part.file->errorString()));
+        return total > 0 ? total : -1;
+      }
+    }
+    else {
+      std::memcpy(data + total, part.data.constData() + offset, size_t(chunk));
+    }
+    total += chunk;
+    _pos += chunk;
+    // a short file read leaves _pos inside this part; the next read picks up from there
+    if (_pos < part.start + part.size)
+      break;
+  }
+  return total;
+}
@@ -0,0 +1,59 @@
+// Copyright 2020, Verizon Media
+// Licensed under the terms of MIT. See LICENSE file in project root for terms.
+
+#pragma once
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QIODevice>
+#include <QList>
+
+/**
+ * @brief The MultipartDevice class is a read-only QIODevice that presents a series of parts (in
+ * memory data, and files) as one continuous stream. File content is read only as the device is
+ * read, a chunk at a time, so the memory used does not depend on the size of the files. This lets
+ * a large multipart body be posted (via QNetworkAccessManager::post) without ever being buffered.
+ * The device supports seeking, so the body can be re-read (e.g. on a redirect).
+ *
+ * The sha256 of the stream is built up as parts are added (each file is read once, a chunk at a
+ * time), so signing a request never needs another pass over the body.
+ */
+class MultipartDevice : public QIODevice {
+  Q_OBJECT
+
+ public:
+  explicit MultipartDevice(QObject *parent = nullptr);
+
+  /// addData appends data to the end of the stream. Parts must be added before the device is opened.
+  void addData(const QByteArray &data);
+  /// addFile appends the content of the file at path to the end of the stream. The file is opened
+  /// here, and stays open for the life of the device. Returns false if the file cannot be opened.
+  bool addFile(const QString &path);
+  /// sha256 returns the hash of the complete stream. Call once every part has been added.
+  QByteArray sha256() const { return _hash.result(); }
+
+  bool open(OpenMode mode) override;
+  bool isSequential() const override { return false; }
+  qint64 size() const override { return _size; }
+  bool seek(qint64 pos) override;
+
+ protected:
+  qint64 readData(char *data, qint64 maxSize) override;
+  qint64 writeData(const char *, qint64) override { return -1; }
+
+ private:
+  /// Part is one piece of the stream: either data, or (when file is set) the content of a file
+  struct Part {
+    QByteArray data;
+    QFile *file = nullptr;
+    /// start is the position of this part's first byte in the stream
+    qint64 start = 0;
+    qint64 size = 0;
+  };
+  void appendPart(Part part);
+
+  QList<Part> _parts;
+  QCryptographicHash _hash{QCryptographicHash::Sha256};
+  qint64 _size = 0;
+  qint64 _pos = 0;
+};
@@ -16,31 +16,39 @@ MultipartParser::MultipartParser()
     : m_boundary(QStringLiteral("----ASHIRTTrayApp%1").arg(StringHelpers::randomString(16)))
 { }
 
-const QByteArray &MultipartParser::generateBody()
+MultipartDevice *MultipartParser::generateBodyDevice(QString *error)
 {
-    m_body.clear();
+    auto device = new MultipartDevice;
+    QByteArray head;
     for (const auto &param : m_paramList) {
-        m_body.append(m_contentHeader.arg(m_boundary).toUtf8());
-        m_body.append(m_contentParam.arg(param.first).toUtf8());
-        m_body.append(param.second.toUtf8());
+        head.append(m_contentHeader.arg(m_boundary).toUtf8());
+        head.append(m_contentParam.arg(param.first).toUtf8());
+        head.append(param.second.toUtf8());
     }
     for (const auto &pair : m_fileList) {
-        QFileInfo info = QFileInfo(pair.second);
-        QString name = info.fileName();
-        QString ext = info.completeSuffix().toLower();
-        QString type = QStringLiteral("application/octet-stream");
-        QByteArray data;
-        QFile file(pair.second);
-        if (file.open(QIODevice::ReadOnly))
-            data = file.readAll();
-        if(ext.endsWith(QStringLiteral("jpg")) || ext.endsWith(QStringLiteral("jpeg")))
-            type = QStringLiteral("image/jpeg");
-        else if(ext.endsWith(QStringLiteral("txt")) || ext.endsWith(QStringLiteral("log")))
-            type = QStringLiteral("text/plain");
-        m_body.append(m_contentHeader.arg(m_boundary).toUtf8());
-        m_body.append(m_contentFile.arg(pair.first, name, type).toUtf8());
-        m_body.append(data);
+        head.append(m_contentHeader.arg(m_boundary).toUtf8());
+        head.append(m_contentFile.arg(pair.first, QFileInfo(pair.second).fileName(), fileContentType(pair.second)).toUtf8());
+        device->addData(head);
+        head.clear();
+        if (!device->addFile(pair.second)) {
+            if (error)
+                *error = QStringLiteral("%1: %2").arg(pair.second, device->errorString());
+            delete device;
+            return nullptr;
+        }
     }
-    m_body.append(QStringLiteral("\r\n--%1--\r\n").arg(m_boundary).toUtf8());
-    return m_body;
+    head.append(QStringLiteral("\r\n--%1--\r\n").arg(m_boundary).toUtf8());
+    device->addData(head);
+    device->open(QIODevice::ReadOnly);
+    return device;
+}
+
+QString MultipartParser::fileContentType(const QString &path)
+{
+    QString ext = QFileInfo(path).completeSuffix().toLower();
+    if(ext.endsWith(QStringLiteral("jpg")) || ext.endsWith(QStringLiteral("jpeg")))
+        return QStringLiteral("image/jpeg");
+    if(ext.endsWith(QStringLiteral("txt")) || ext.endsWith(QStringLiteral("log")))
+        return QStringLiteral("text/plain");
+    return QStringLiteral("application/octet-stream");
 }
@@ -12,6 +12,8 @@
 #include <QPair>
 #include <QString>
 
+#include "multipartdevice.h"
+
 class MultipartParser {
  public:
   MultipartParser();
@@ -22,13 +24,16 @@ class MultipartParser {
   inline void addFile(const QString &name = QString(), const QString &value = QString()) {
       m_fileList.append(QPair<QString, QString>(name, value));
   }
-  const QByteArray &generateBody();
+  /// generateBodyDevice returns the (opened) body as a device that streams files as it is read,
+  /// rather than holding them in memory. The caller owns the device. Returns nullptr if a file
+  /// cannot be read, setting error (if provided) to the reason.
+  MultipartDevice *generateBodyDevice(QString *error = nullptr);
  private:
+  static QString fileContentType(const QString &path);
   inline static const auto m_contentHeader = QStringLiteral("\r\n--%1\r\n");
   inline static const auto m_contentParam = QStringLiteral("Content-Disposition: form-data; name=\"%1\"\r\n\r\n");
   inline static const auto m_contentFile = QStringLiteral("Content-Disposition: form-data; name=\"%1\"; filename=\"%2\"\r\nContent-Type: %3\r\n\r\n");
   QString m_boundary;
-  QByteArray m_body;
   QList<QPair<QString, QString>> m_paramList;
   QList<QPair<QString, QString>> m_fileList;
 };
@@ -40,7 +40,8 @@ public:
   /// to the configured ASHIRT API server. Returns a QNetworkReply to track the request
   /// Note: does not specify the occurred_at field, so occurred_at will reflect the time of upload,
   /// rather than the time of capture.
-  static QNetworkReply* uploadAsset(model::Evidence evidence) {
+  /// Returns nullptr if the evidence file cannot be read, setting error (if provided) to the reason.
+  static QNetworkReply* uploadAsset(model::Evidence evidence, QString* error = nullptr) {
     MultipartParser parser;
     parser.addParameter(QStringLiteral("notes"), evidence.description);
     parser.addParameter(QStringLiteral("contentType"), evidence.contentType);
@@ -53,7 +54,11 @@ public:
 
     parser.addParameter(QStringLiteral("tagIds"), QStringLiteral("[%1]").arg(list.join(QStringLiteral(","))));
     parser.addFile(QStringLiteral("file"), evidence.path);
-    auto builder = ashirtFormPost(QStringLiteral("/api/operations/%1/evidence").arg(evidence.operationSlug), parser.generateBody(), parser.boundary());
+    // the body is streamed from the evidence file, so large evidence is never held in memory
+    auto body = parser.generateBodyDevice(error);
+    if (!body)
+      return nullptr;
+    auto builder = ashirtFormPost(QStringLiteral("/api/operations/%1/evidence").arg(evidence.operationSlug), body, parser.boundary());
     addASHIRTAuth(builder);
     return builder->execute(get()->nam);
   }
@@ -108,6 +113,14 @@ public:
     connect(get()->testConnectionReply, &QNetworkReply::finished, get(), processTestResults);
   }
 
+  /// checkConnection requests the check connection endpoint of the configured ASHIRT API server.
+  /// Used to probe whether the server is reachable; any response from the server means it is.
+  static QNetworkReply *checkConnection() {
+    auto builder = ashirtGet(QStringLiteral("/api/checkconnection"));
+    addASHIRTAuth(builder);
+    return builder->execute(get()->nam);
+  }
+
   /// getAllOperations retrieves all (user-visble) operations from the configured ASHIRT API server.
   /// Note: normally you should opt to use refreshOperationsList and retrieve the results by listening
   /// for the operationListUpdated signal.
@@ -196,6 +209,8 @@ private:
  };
 
  QString _lastTestError;
+ QString _encodedSecretKey;
+ QByteArray _decodedSecretKey;
 
  /// ashirtGet generates a basic GET request to the ashirt API server. No authentication is
  /// provided (use addASHIRTAuth to do this)
@@ -217,13 +232,13 @@ private:
        ->setBody(body);
  }
 
- /// ashirtFormPost generates a basic POST request with content type multipart/form-data.
- /// No authentication is provided (use addASHIRTAuth to do this)
- static RequestBuilder* ashirtFormPost(QString endpoint, QByteArray body, QString boundry) {
+ /// ashirtFormPost generates a basic POST request with content type multipart/form-data, streaming
+ /// the body from the given device. No authentication is provided (use addASHIRTAuth to do this)
+ static RequestBuilder* ashirtFormPost(QString endpoint, MultipartDevice* body, QString boundry) {
    return RequestBuilder::newFormPost(boundry)
        ->setHost(AppConfig::value(CONFIG::APIURL))
        ->setEndpoint(endpoint)
-       ->setBody(body);
+       ->setBody(body, body->sha256());
  }
 
  /// addASHIRTAuth takes the provided RequestBuilder and adds on Authorization and Date headers
@@ -238,7 +253,7 @@ private:
    QString apiKeyCopy = altApiKey.isEmpty() ? AppConfig::value(CONFIG::ACCESSKEY) : QString(altApiKey);
 
    auto code = generateHash(RequestMethodToString(reqBuilder->getMethod()),
-                            reqBuilder->getEndpoint(), now, reqBuilder->getBody(), altSecretKey);
+                            reqBuilder->getEndpoint(), now, reqBuilder->getBodySha256(), altSecretKey);
 
    auto authValue = QStringLiteral("%1:%2").arg(apiKeyCopy, code);
    reqBuilder->addRawHeader(QStringLiteral("Authorization"), authValue);
@@ -246,19 +261,29 @@ private:
 
 
  /// generateHash provides a cryptographic hash for ASHIRT api server communication
- static QString generateHash(QString method, QString path, QString date, QByteArray body = NO_BODY,
+ /// bodyHash is the sha256 of the request body
+ static QString generateHash(QString method, QString path, QString date, const QByteArray &bodyHash,
                       const QString &secretKey = QString()) {
 
    QString msg  = QStringLiteral("%1\n%2\n%3\n").arg(method, path, date);
    QString secretKeyCopy = secretKey.isEmpty() ? AppConfig::value(CONFIG::SECRETKEY) : QString(secretKey);
 
-   QMessageAuthenticationCode code(QCryptographicHash::Sha256);
-   code.setKey(QByteArray::fromBase64(secretKeyCopy.toUtf8()));
+   QMessageAuthenticationCode code(QCryptographicHash::Sha256, decodedSecretKey(secretKeyCopy));
    code.addData(msg.toLatin1());
-   code.addData(QCryptographicHash::hash(body, QCryptographicHash::Sha256));
+   code.addData(bodyHash);
    return code.result().toBase64();
  }
 
+ /// decodedSecretKey returns the base64 decoded secretKey. The most recently used key is cached,
+ /// since the same key is normally used for every request.
+ static QByteArray decodedSecretKey(const QString &secretKey) {
+   if (secretKey != get()->_encodedSecretKey) {
+     get()->_encodedSecretKey = secretKey;
+     get()->_decodedSecretKey = QByteArray::fromBase64(secretKey.toUtf8());
+   }
+   return get()->_decodedSecretKey;
+ }
+
  /// onGetOpsComplete is called when the network request associated with the method refreshOperationsList
  /// completes. This will emit an operationListUpdated signal.
  static void onGetOpsComplete() {
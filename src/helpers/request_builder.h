@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QCryptographicHash>
+#include <QIODevice>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 
@@ -39,6 +41,10 @@ class RequestBuilder {
  private:
   RequestMethod method;
   QByteArray body = NO_BODY;
+  /// bodyDevice, when set, is posted in place of body
+  QIODevice* bodyDevice = nullptr;
+  /// bodySha256 caches the hash of the body, when known up front
+  QByteArray bodySha256;
   QString host;
   QString endpoint;
 
@@ -82,10 +88,28 @@ class RequestBuilder {
   }
 
   /// getBody retrieves the set body
-  QByteArray getBody() {
+  const QByteArray& getBody() {
     return this->body;
   }
 
+  /// getBodyDevice retrieves the set body device (or nullptr, if the body is not a device)
+  QIODevice* getBodyDevice() {
+    return this->bodyDevice;
+  }
+
+  /// getBodySha256 retrieves the sha256 of the body. Unless it was provided with the body, it is
+  /// computed here (reading a body device a chunk at a time, then rewinding it).
+  QByteArray getBodySha256() {
+    if (!bodySha256.isEmpty())
+      return bodySha256;
+    if (!bodyDevice)
+      return QCryptographicHash::hash(body, QCryptographicHash::Sha256);
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(bodyDevice);
+    bodyDevice->reset();
+    return hash.result();
+  }
+
   /// getEndpoint retrieves the set endpoint
   QString getEndpoint() {
     return this->endpoint;
@@ -114,8 +138,18 @@ class RequestBuilder {
   }
 
   /// setBody sets the body for this request
-  RequestBuilder* setBody(QByteArray body) {
+  RequestBuilder* setBody(const QByteArray& body) {
     this->body = body;
+    this->bodySha256.clear();
+    return this;
+  }
+
+  /// setBody sets an (open, seekable) device to stream the body from. Once executed, the
+  /// device is owned by the reply; until then, it is owned by the caller.
+  /// sha256 may provide the hash of the device's content, if already known
+  RequestBuilder* setBody(QIODevice* device, const QByteArray& sha256 = QByteArray()) {
+    this->bodyDevice = device;
+    this->bodySha256 = sha256;
     return this;
   }
 
@@ -152,6 +186,10 @@ class RequestBuilder {
       req.setHeader(header.first, header.second);
     }
 
+    if (bodyDevice) {
+      req.setHeader(QNetworkRequest::ContentLengthHeader, bodyDevice->size());
+    }
+
     QString url = this->host;
     if (url.length() > 0 && url.at(url.size() - 1) == '/') {
       url.chop(1);
@@ -178,7 +216,13 @@ class RequestBuilder {
         reply = nam->get(req);
         break;
       case METHOD_POST:
-        reply = nam->post(req, body);
+        if (bodyDevice) {
+          reply = nam->post(req, bodyDevice);
+          bodyDevice->setParent(reply);
+        }
+        else {
+          reply = nam->post(req, body);
+        }
         break;
       default:
         qWarning() << "Requestbuilder contains an unsupported request method";
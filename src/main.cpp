@@ -2,10 +2,16 @@
 // Licensed under the terms of MIT. See LICENSE file in project root for terms.
 
 #include <QApplication>
+#include <QEventLoop>
 #include <QMessageBox>
 #include <QMetaType>
 
-#include "db/databaseconnection.h"
+#include "appconfig.h"
+#include "components/upload_queue/uploadqueue.h"
+#include "db/databasemaintenance.h"
+#include "db/databaseworker.h"
+#include "db/evidencecollector.h"
+#include "helpers/file_helpers.h"
 #include "traymanager.h"
 
 QIcon getWindowIcon() { return QIcon(QStringLiteral(":icons/windowIcon.png")); }
@@ -15,6 +21,38 @@ void showMsgBox(const QString &errorText = QString())
     QMessageBox::critical(nullptr, QT_TRANSLATE_NOOP("main", "ASHIRT Error"), errorText);
 }
 
+/// pragmasFromConfig reads the database tuning values from the AppConfig, keeping the built in
+/// default for any numeric value that does not parse.
+SqlitePragmas pragmasFromConfig()
+{
+    SqlitePragmas pragmas;
+    auto readNumber = [](const QString &key, qint64 fallback) {
+        bool ok = false;
+        auto value = AppConfig::value(key).toLongLong(&ok);
+        return ok ? value : fallback;
+    };
+    pragmas.journalMode = AppConfig::value(CONFIG::DB_JOURNAL_MODE);
+    pragmas.synchronous = AppConfig::value(CONFIG::DB_SYNCHRONOUS);
+    pragmas.tempStore = AppConfig::value(CONFIG::DB_TEMP_STORE);
+    pragmas.mmapSize = readNumber(CONFIG::DB_MMAP_SIZE, pragmas.mmapSize);
+    pragmas.cacheSize = readNumber(CONFIG::DB_CACHE_SIZE, pragmas.cacheSize);
+    pragmas.busyTimeout = readNumber(CONFIG::DB_BUSY_TIMEOUT, pragmas.busyTimeout);
+    return pragmas;
+}
+
+/// writeQueryStats saves the statement timings to the file named by dbQueryStatsFile, if one is
+/// set. Files ending in .csv are written as CSV, anything else as JSON.
+void writeQueryStats()
+{
+    auto path = AppConfig::value(CONFIG::DB_QUERY_STATS_FILE);
+    if (path.isEmpty())
+        return;
+    auto &stats = DatabaseConnection::queryStats();
+    auto data = path.endsWith(QStringLiteral(".csv"), Qt::CaseInsensitive) ? stats.toCsv() : stats.toJson();
+    if (!FileHelpers::writeFile(path, data))
+        qWarning() << "Unable to write query stats to" << path;
+}
+
 int main(int argc, char* argv[])
 {
     Q_INIT_RESOURCE(res_icons);
@@ -37,19 +75,57 @@ int main(int argc, char* argv[])
         return -1;
     }
 
-    auto conn = new DatabaseConnection(Constants::dbLocation, Constants::defaultDbName);
-    if(!conn->connect()) {
-        showMsgBox(QString(QT_TRANSLATE_NOOP("main", "Database Error: %1")).arg(conn->errorString()));
+    DatabaseConnection::setPragmaProfile(pragmasFromConfig());
+    bool slowQueryMsOk = false;
+    auto slowQueryMs = AppConfig::value(CONFIG::DB_SLOW_QUERY_MS).toInt(&slowQueryMsOk);
+    if (slowQueryMsOk)
+        DatabaseConnection::queryStats().setSlowThresholdMs(slowQueryMs);
+    // the readers are only started if the database turns out to be in WAL mode (see open)
+    auto conn = new DatabaseWorker(Constants::dbLocation, Constants::defaultDbName,
+                                   DatabaseWorker::defaultReaderCount);
+
+    // migrating a large database can take a while, so show progress in the tray until it is done,
+    // rather than appearing to hang
+    QSystemTrayIcon migrationTray(getWindowIcon());
+    QObject::connect(conn, &DatabaseWorker::migrationProgress, &migrationTray,
+                     [&migrationTray](const QString& migrationName, int percentDone) {
+        migrationTray.setToolTip(QString(QT_TRANSLATE_NOOP("main", "Updating database: %1 (%2%)"))
+                                     .arg(migrationName).arg(percentDone));
+        if (!migrationTray.isVisible()) {
+            migrationTray.show();
+            migrationTray.showMessage(QT_TRANSLATE_NOOP("main", "Updating database"),
+                                      QT_TRANSLATE_NOOP("main", "This may take a few minutes"));
+        }
+    });
+    QEventLoop waitForOpen;
+    auto opened = conn->open();
+    opened.then(&waitForOpen, [&waitForOpen](const DatabaseResult&) { waitForOpen.quit(); });
+    if (!opened.isFinished())
+        waitForOpen.exec();
+    migrationTray.hide();
+
+    if(!opened.result().success) {
+        showMsgBox(QString(QT_TRANSLATE_NOOP("main", "Database Error: %1")).arg(opened.result().errorText));
+        delete conn;
         return -1;
     }
 
+    // purges evidence deleted in this (or a previous) session, once things are quiet
+    auto collector = new EvidenceCollector(conn, conn);
+    collector->collectSoon();
+
     app.setQuitOnLastWindowClosed(false);
     qRegisterMetaType<model::Tag>();
-    auto window = new TrayManager(nullptr, conn);
+    // uploads evidence in the background, picking up anything left queued by the last session
+    auto uploads = new UploadQueue(conn, conn);
+    auto window = new TrayManager(nullptr, conn, uploads, collector);
+    // keeps the database tuned (and compact) in idle time, staying out of the way of captures
+    auto maintenance = new DatabaseMaintenance(conn, conn);
+    QObject::connect(window, &TrayManager::captureStarted, maintenance, &DatabaseMaintenance::postpone);
 
     QObject::connect(&app, &QApplication::aboutToQuit, [conn] {
-        conn->close();
         delete conn;
+        writeQueryStats();
     });
 
     int rtn = app.exec();
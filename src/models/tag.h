@@ -36,6 +36,8 @@ class Tag {
   qint64 serverTagId;
   QString tagName;
   qint64 evidenceId;
+  /// colorName is the last known (server) color for the tag; empty if never known
+  QString colorName;
 };
 }  // namespace model
 Q_DECLARE_METATYPE(model::Tag)
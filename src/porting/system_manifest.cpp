@@ -4,7 +4,7 @@
 
 using namespace porting;
 
-void SystemManifest::applyManifest(SystemManifestImportOptions options, DatabaseConnection* systemDb)
+bool SystemManifest::applyManifest(SystemManifestImportOptions options, DatabaseConnection* systemDb)
 {
     bool shouldMigrateConfig = options.importConfig && !configPath.isEmpty();
     bool shouldMigrateDb = options.importDb == SystemManifestImportOptions::Merge && !dbPath.isEmpty();
@@ -14,25 +14,62 @@ void SystemManifest::applyManifest(SystemManifestImportOptions options, Database
         AppConfig::importConfig(configPath);
     }
 
+    bool imported = true;
     if (shouldMigrateDb) {
-        migrateDb(systemDb);
+        imported = migrateDb(systemDb);
     }
     Q_EMIT onComplete();
+    return imported;
 }
 
-void SystemManifest::migrateDb(DatabaseConnection* systemDb)
+bool SystemManifest::migrateDb(DatabaseConnection* systemDb)
 {
     Q_EMIT onStatusUpdate(tr("Reading Exported Evidence"));
     auto evidenceManifest = EvidenceManifest::deserialize(pathToFile(evidenceManifestPath));
     Q_EMIT onReady(evidenceManifest.entries.size());
+    bool imported = false;
     DatabaseConnection::withConnection(
-                pathToFile(dbPath), QStringLiteral("importDb"), [this, evidenceManifest, systemDb](DatabaseConnection importDb) {
+                pathToFile(dbPath), QStringLiteral("importDb"), [this, evidenceManifest, systemDb, &imported](DatabaseConnection importDb) {
         Q_EMIT onStatusUpdate(tr("Importing evidence"));
+        QList<qint64> importIDs;
+        importIDs.reserve(evidenceManifest.entries.size());
+        for (const auto &entry : evidenceManifest.entries)
+            importIDs.append(entry.evidenceID);
+        auto importRecords = importDb.getEvidenceDetails(importIDs);
+
+        // files are copied outside of any transaction, and their evidence is written a chunk at a
+        // time, so the running application is only held up (e.g. a capture) while a chunk is written
+        size_t importedCount = 0;
+        bool writeFailed = false;
+        QList<model::Evidence> copied;
+        auto writeCopied = [systemDb, &copied, &importedCount, &writeFailed]() {
+            if (copied.isEmpty())
+                return true;
+            DatabaseTransaction transaction(systemDb);
+            bool written = transaction.isActive();
+            for (int i = 0; written && i < copied.size(); i++) {
+                qint64 evidenceID = systemDb->createFullEvidence(copied.at(i));
+                written = evidenceID != -1 && systemDb->setEvidenceTags(copied.at(i).tags, evidenceID);
+            }
+            if (!written || !transaction.commit()) {
+                transaction.rollback();
+                // the evidence was not written, so its files are not kept either
+                for (const auto &record : copied)
+                    QFile::remove(record.path);
+                copied.clear();
+                writeFailed = true;
+                return false;
+            }
+            importedCount += copied.size();
+            copied.clear();
+            return true;
+        };
+
         for (size_t entryIndex = 0; entryIndex < evidenceManifest.entries.size(); entryIndex++) {
             Q_EMIT onFileProcessed(entryIndex); // this only makes sense on the 2nd+ iteration, but this works since indexes start at 0
             auto item = evidenceManifest.entries.at(entryIndex);
-            auto importRecord = importDb.getEvidenceDetails(item.evidenceID);
-            if (importRecord.id == 0)
+            auto importRecord = importRecords.at(entryIndex);
+            if (importRecord.id == -1)
                 continue; // in the odd situation that evidence doesn't match up, just skip it
             QString newEvidencePath = QStringLiteral("%1/%2/%3")
                     .arg(AppConfig::value(CONFIG::EVIDENCEREPO)
@@ -46,18 +83,34 @@ void SystemManifest::migrateDb(DatabaseConnection* systemDb)
             QFile srcFile(fullFileExportPath);
             srcFile.copy(newEvidencePath);
             if (srcFile.error() != QFileDevice::NoError) {
+                // the evidence whose files were already copied is kept, and reported as a partial import
+                writeCopied();
                 Q_EMIT onCopyFileError(
                             fullFileExportPath, newEvidencePath,
-                            QStringLiteral("Unable to write to file: %1\n%2").arg(newEvidencePath, srcFile.error()));
+                            QStringLiteral("Unable to write to file: %1\n%2").arg(newEvidencePath, srcFile.errorString()));
+                Q_EMIT onStatusUpdate(tr("Import stopped after %1 of %2 evidence. Unable to copy %3: %4")
+                                      .arg(importedCount).arg(evidenceManifest.entries.size())
+                                      .arg(fullFileExportPath, srcFile.errorString()));
                 return;
             }
 
             importRecord.path = newEvidencePath;
-            qint64 evidenceID = systemDb->createFullEvidence(importRecord);
-            systemDb->setEvidenceTags(importRecord.tags, evidenceID);
+            // older exports may include pending tags, whose placeholder ids mean nothing here
+            importRecord.tags.removeIf([](const model::Tag& tag) { return PendingTag::isPlaceholder(tag.serverTagId); });
+            copied.append(importRecord);
+            if (copied.size() >= m_importChunkSize && !writeCopied())
+                break;
+        }
+        if (writeFailed || !writeCopied()) {
+            // the failing statement has already been logged
+            Q_EMIT onStatusUpdate(tr("Import stopped after %1 of %2 evidence. Unable to save the imported evidence.")
+                                  .arg(importedCount).arg(evidenceManifest.entries.size()));
+            return;
         }
+        imported = true;
         Q_EMIT onFileProcessed(evidenceManifest.entries.size()); // update the full set now that this is complete
     });
+    return imported;
 }
 
 QString SystemManifest::pathToFile(const QString& filename)
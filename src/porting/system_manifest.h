@@ -36,8 +36,9 @@ namespace porting {
     * @brief applyManifest takes the given manifest object (and options), and begins merging that data with the running system
     * @param options switches to control what gets imported
     * @param systemDb The currently running/system database
+    * @return false if the evidence could not all be imported (see migrateDb)
     */
-    void applyManifest(SystemManifestImportOptions options, DatabaseConnection* systemDb);
+    bool applyManifest(SystemManifestImportOptions options, DatabaseConnection* systemDb);
 
     /**
     * @brief exportManifest starts the long process of copying config and evidence into the specified directory.
@@ -97,10 +98,13 @@ namespace porting {
     * emits onStatusUpdate signal for periodic progress updates
     * emits onCopyFileError signal if there is an issue copying evidence files
     * emits onFileProcessed for each file processed
+    * Evidence is written in chunks of m_importChunkSize, after its files are copied. If a file
+    * cannot be copied, or a chunk cannot be written, the import stops there, keeping the evidence
+    * already written, and reports how far it got (onStatusUpdate)
     * @param systemDb a pointer to the "standard" system database/running database
-    * @throws QSqlError
+    * @return true if all of the evidence was imported
     */
-    void migrateDb(DatabaseConnection* systemDb);
+    bool migrateDb(DatabaseConnection* systemDb);
 
     /// pathToFile is a small helper method to combine the absolute path to the manifest with the relative
     /// path to the given filename. The result is an absolute path to the given file
@@ -121,5 +125,6 @@ namespace porting {
     /// pathToManifest is the (absolute) path to the system manifest file from the originating export
     QString m_pathToManifest;
     inline static const QString m_fileTemplate = QStringLiteral("%1/%2");
+    inline static const int m_importChunkSize = 100;
   };
 }
@@ -17,7 +17,9 @@
 #include <QDesktopServices>
 #include <iostream>
 #include "appconfig.h"
-#include "db/databaseconnection.h"
+#include "components/connectivity/connectivitymonitor.h"
+#include "components/upload_queue/uploadqueue.h"
+#include "db/databaseworker.h"
 #include "forms/getinfo/getinfo.h"
 #include "helpers/netman.h"
 #include "helpers/screenshot.h"
@@ -26,13 +28,14 @@
 #include "hotkeymanager.h"
 #include "models/codeblock.h"
 
-TrayManager::TrayManager(QWidget * parent, DatabaseConnection* db)
+TrayManager::TrayManager(QWidget * parent, DatabaseWorker* db, UploadQueue* uploads, EvidenceCollector* collector)
     : QDialog(parent)
     , db(db)
+    , uploads(uploads)
     , screenshotTool(new Screenshot(this))
     , updateCheckTimer(new QTimer(this))
     , settingsWindow(new Settings(this))
-    , evidenceManagerWindow(new EvidenceManager(this->db, this))
+    , evidenceManagerWindow(new EvidenceManager(this->db, this->uploads, collector, this))
     , creditsWindow(new Credits(this))
     , importWindow(new PortingDialog(PortingDialog::Import, this->db, this))
     , exportWindow(new PortingDialog(PortingDialog::Export, this->db, this))
@@ -116,6 +119,8 @@ void TrayManager::wireUi() {
   connect(NetMan::get(), &NetMan::operationListUpdated, this, &TrayManager::onOperationListUpdated);
   connect(NetMan::get(), &NetMan::releasesChecked, this, &TrayManager::onReleaseCheck);
   connect(AppConfig::get(), &AppConfig::operationChanged, this, &TrayManager::setActiveOperationLabel);
+  connect(uploads, &UploadQueue::uploadFailed, this, &TrayManager::onUploadFailed);
+  connect(ConnectivityMonitor::get(), &ConnectivityMonitor::onlineChanged, this, &TrayManager::onOnlineChanged);
 
   connect(trayIcon, &QSystemTrayIcon::messageClicked, this, &TrayManager::onTrayMessageClicked);
   connect(trayIcon, &QSystemTrayIcon::activated, this, [this] {
@@ -157,18 +162,31 @@ void TrayManager::changeEvent(QEvent *event)
 }
 
 void TrayManager::spawnGetInfoWindow(qint64 evidenceID) {
-  auto getInfoWindow = new GetInfo(db, evidenceID, this);
+  auto getInfoWindow = new GetInfo(db, uploads, evidenceID, this);
   connect(getInfoWindow, &GetInfo::evidenceSubmitted, [](const model::Evidence& evi) {
     AppConfig::setLastUsedTags(evi.tags);
   });
   getInfoWindow->show();
 }
 
-qint64 TrayManager::createNewEvidence(const QString& filepath, const QString& evidenceType) {
-  auto evidenceID = db->createEvidence(filepath, AppConfig::operationSlug(), evidenceType);
+void TrayManager::createNewEvidence(const QString& filepath, const QString& evidenceType) {
+  auto operationSlug = AppConfig::operationSlug();
   auto tags = AppConfig::getLastUsedTags();
-  db->setEvidenceTags(tags, evidenceID);
-  return evidenceID;
+  db->run([filepath, evidenceType, operationSlug, tags](DatabaseConnection* conn) {
+    DatabaseTransaction transaction(conn);
+    auto evidenceID = conn->createEvidence(filepath, operationSlug, evidenceType);
+    if (evidenceID != -1)
+      conn->setEvidenceTags(tags, evidenceID);
+    if (!transaction.commit())
+      return qint64(-1);
+    return evidenceID;
+  }).then(this, [this](qint64 evidenceID) {
+    if (evidenceID == -1) {
+      showDBWriteErrorTrayMessage();
+      return;
+    }
+    spawnGetInfoWindow(evidenceID);
+  });
 }
 
 void TrayManager::captureWindowActionTriggered() {
@@ -176,6 +194,7 @@ void TrayManager::captureWindowActionTriggered() {
     showNoOperationSetTrayMessage();
     return;
   }
+  Q_EMIT captureStarted();
   screenshotTool->captureWindow();
 }
 
@@ -184,6 +203,7 @@ void TrayManager::captureAreaActionTriggered() {
     showNoOperationSetTrayMessage();
     return;
   }
+  Q_EMIT captureStarted();
   screenshotTool->captureArea();
 }
 
@@ -192,6 +212,7 @@ void TrayManager::captureClipboardActionTriggered() {
     showNoOperationSetTrayMessage();
     return;
   }
+  Q_EMIT captureStarted();
   onClipboardCapture();
 }
 void TrayManager::onClipboardCapture()
@@ -220,22 +241,12 @@ void TrayManager::onClipboardCapture()
         return;
     }
 
-    int evidenceID = createNewEvidence(path, type);
-    if(evidenceID == -1) {
-        showDBWriteErrorTrayMessage();
-        return;
-    }
-    spawnGetInfoWindow(evidenceID);
+    createNewEvidence(path, type);
 }
 
 void TrayManager::onScreenshotCaptured(const QString& path)
 {
-  auto evidenceID = createNewEvidence(path, QStringLiteral("image"));
-  if(evidenceID == -1) {
-      showDBWriteErrorTrayMessage();
-      return;
-  }
-    spawnGetInfoWindow(evidenceID);
+  createNewEvidence(path, QStringLiteral("image"));
 }
 
 void TrayManager::showDBWriteErrorTrayMessage()
@@ -302,6 +313,27 @@ void TrayManager::onReleaseCheck(bool success, const QList<dto::GithubRelease>&
   }
 }
 
+void TrayManager::onUploadFailed(qint64 evidenceID, const QString& error, bool willRetry) {
+  Q_UNUSED(evidenceID);
+  if (willRetry)
+    return;
+  setTrayMessage(NO_ACTION, tr("Unable to Submit Evidence"),
+                 tr("%1\nThe evidence has been saved, and can be re-submitted from the evidence manager.").arg(error),
+                 QSystemTrayIcon::Warning);
+}
+
+void TrayManager::onOnlineChanged(bool online) {
+  if (online) {
+    setTrayMessage(NO_ACTION, tr("ASHIRT Server Reachable"),
+                   tr("Back online. Evidence and tags captured offline are being submitted."));
+    return;
+  }
+  setTrayMessage(NO_ACTION, tr("Working Offline"),
+                 tr("The ASHIRT server cannot be reached. Keep capturing: submitted evidence, and new tags,"
+                    " are kept and sent once the server is back."),
+                 QSystemTrayIcon::Warning);
+}
+
 void TrayManager::setTrayMessage(MessageType type, const QString& title, const QString& message,
                                  QSystemTrayIcon::MessageIcon icon, int millisecondsTimeoutHint) {
   trayIcon->showMessage(title, message, icon, millisecondsTimeoutHint);
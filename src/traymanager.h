@@ -6,7 +6,7 @@
 #include <QActionGroup>
 #include <QSystemTrayIcon>
 
-#include "db/databaseconnection.h"
+#include "db/databaseworker.h"
 #include "dtos/operation.h"
 #include "dtos/github_release.h"
 #include "forms/credits/credits.h"
@@ -34,6 +34,9 @@ class QTextEdit;
 class QTimer;
 QT_END_NAMESPACE
 
+class EvidenceCollector;
+class UploadQueue;
+
 /**
  * @brief The MessageType enum specifies how to respond to a click on a tray message
  * @see openServicesPath
@@ -51,13 +54,20 @@ class TrayManager : public QDialog {
   Q_OBJECT
 
  public:
-  TrayManager(QWidget* parent = nullptr, DatabaseConnection *db = nullptr);
+  TrayManager(QWidget* parent = nullptr, DatabaseWorker *db = nullptr, UploadQueue *uploads = nullptr,
+              EvidenceCollector *collector = nullptr);
   ~TrayManager();
 
+ Q_SIGNALS:
+  /// captureStarted is emitted as a capture (of any kind) begins
+  void captureStarted();
+
  private:
   void buildUi();
   void wireUi();
-  qint64 createNewEvidence(const QString& filepath, const QString& evidenceType);
+  /// createNewEvidence records the given file as evidence for the current operation (in the background),
+  /// then opens the GetInfo window for it. Shows a tray message if the evidence could not be recorded.
+  void createNewEvidence(const QString& filepath, const QString& evidenceType);
   void spawnGetInfoWindow(qint64 evidenceID);
   void showNoOperationSetTrayMessage();
   void showDBWriteErrorTrayMessage();
@@ -73,6 +83,10 @@ class TrayManager : public QDialog {
   void onOperationListUpdated(bool success, const QList<dto::Operation> &operations);
   void onReleaseCheck(bool success, const QList<dto::GithubRelease>& releases);
   void onTrayMessageClicked();
+  /// onUploadFailed lets the user know when an upload has failed for good, as no window is waiting on it
+  void onUploadFailed(qint64 evidenceID, const QString& error, bool willRetry);
+  /// onOnlineChanged lets the user know that capture carries on offline, and when the server is back
+  void onOnlineChanged(bool online);
 
  public slots:
   void onScreenshotCaptured(const QString &filepath);
@@ -89,7 +103,8 @@ class TrayManager : public QDialog {
  private:
   inline static const int MS_IN_DAY = 86400000;
   QString _recordErrorTitle = tr("Unable to Record Evidence");
-  DatabaseConnection *db = nullptr;
+  DatabaseWorker *db = nullptr;
+  UploadQueue *uploads = nullptr;
   Screenshot *screenshotTool = nullptr;
   QTimer *updateCheckTimer = nullptr;
   MessageType currentTrayMessage = NO_ACTION;